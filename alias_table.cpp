@@ -0,0 +1,45 @@
+#include "alias_table.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+TAliasTable::TAliasTable(const std::vector<double>& weights)
+    : Probabilities(weights.size())
+    , Aliases(weights.size())
+{
+    const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if (weights.empty() || !(total > 0) || std::any_of(weights.begin(), weights.end(), [](double w) { return w < 0; })) {
+        throw std::runtime_error("Weights must be non-negative and not all zero");
+    }
+    std::vector<double> scaled(weights.size());
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        scaled[i] = weights[i] * weights.size() / total;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const auto less = small.back();
+        small.pop_back();
+        const auto more = large.back();
+        Probabilities[less] = scaled[less];
+        Aliases[less] = more;
+        scaled[more] -= 1 - scaled[less];
+        if (scaled[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    for (const auto i : small) {
+        Probabilities[i] = 1;
+    }
+    for (const auto i : large) {
+        Probabilities[i] = 1;
+    }
+}
+
+uint32_t TAliasTable::Sample(double unit) const {
+    const auto scaled = unit * Probabilities.size();
+    const auto index = std::min<size_t>(scaled, Probabilities.size() - 1);
+    return scaled - index < Probabilities[index] ? index : Aliases[index];
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Таблица псевдонимов Уолкера: выборка из дискретного распределения за O(1) по одному числу
+class TAliasTable {
+public:
+    // Веса неотрицательны и не все нулевые, иначе бросает исключение
+    explicit TAliasTable(const std::vector<double>& weights);
+
+    // Номер значения по равномерному числу из [0, 1)
+    uint32_t Sample(double unit) const;
+
+private:
+    std::vector<double> Probabilities;
+    std::vector<uint32_t> Aliases;
+};
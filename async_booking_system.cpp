@@ -0,0 +1,186 @@
+#include "async_booking_system.h"
+#include "trace.h"
+#include <memory>
+#include <stdexcept>
+
+TAsyncBookingSystem::TAsyncBookingSystem(
+    IBookingSystem& bookingSystem,
+    size_t maxBatchSize,
+    TAvailabilityPublisher* publisher
+)
+    : BookingSystem(bookingSystem)
+    , MaxBatchSize(maxBatchSize)
+    , Publisher(publisher)
+{
+    if (MaxBatchSize == 0) {
+        throw std::runtime_error("Batch size must be positive");
+    }
+    PublishAvailability();
+    Owner = std::thread([this] { Run(); });
+}
+
+TAsyncBookingSystem::~TAsyncBookingSystem() {
+    Stop();
+}
+
+std::future<bool> TAsyncBookingSystem::Book(const TBooking& booking) {
+    return Enqueue<bool>(EAction::Book, booking);
+}
+
+void TAsyncBookingSystem::Book(const TBooking& booking, TBookCallback callback) {
+    Enqueue(EAction::Book, booking, [callback = std::move(callback)](TCost result, bool success) {
+        callback(success && result != 0);
+    });
+}
+
+std::future<bool> TAsyncBookingSystem::CheckInto(const TBooking& booking) {
+    return Enqueue<bool>(EAction::CheckInto, booking);
+}
+
+void TAsyncBookingSystem::CheckInto(const TBooking& booking, TBookCallback callback) {
+    Enqueue(EAction::CheckInto, booking, [callback = std::move(callback)](TCost result, bool success) {
+        callback(success && result != 0);
+    });
+}
+
+std::future<TCost> TAsyncBookingSystem::GetBill(const TBooking& booking) {
+    return Enqueue<TCost>(EAction::GetBill, booking);
+}
+
+void TAsyncBookingSystem::GetBill(const TBooking& booking, TBillCallback callback) {
+    Enqueue(EAction::GetBill, booking, std::move(callback));
+}
+
+void TAsyncBookingSystem::Stop() {
+    Stopping.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> guard(WakeupMutex);
+        Wakeup.notify_one();
+    }
+    if (Owner.joinable()) {
+        Owner.join();
+    }
+}
+
+template <typename TResult>
+std::future<TResult> TAsyncBookingSystem::Enqueue(EAction action, const TBooking& booking) {
+    // std::function требует копируемости, поэтому promise живет в shared_ptr
+    auto promise = std::make_shared<std::promise<TResult>>();
+    auto future = promise->get_future();
+    auto reply = [promise](TCost result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(static_cast<TResult>(result));
+        }
+    };
+    Enqueue({action, booking, std::move(reply)});
+    return future;
+}
+
+void TAsyncBookingSystem::Enqueue(EAction action, const TBooking& booking, TBillCallback callback) {
+    auto reply = [callback = std::move(callback)](TCost result, std::exception_ptr error) {
+        try {
+            callback(error ? 0 : result, !error);
+        } catch (...) {
+        }
+    };
+    Enqueue({action, booking, std::move(reply)});
+}
+
+void TAsyncBookingSystem::Enqueue(TRequest request) {
+    // Пара PendingPushes/Stopping работает как у Деккера: либо писатель увидит остановку,
+    // либо владелец перед последним разбором очереди дождется его Push
+    PendingPushes.fetch_add(1, std::memory_order_seq_cst);
+    if (Stopping.load(std::memory_order_seq_cst)) {
+        PendingPushes.fetch_sub(1, std::memory_order_release);
+        throw std::runtime_error("Booking system is stopped");
+    }
+    try {
+        Queue.Push(std::move(request));
+    } catch (...) {
+        PendingPushes.fetch_sub(1, std::memory_order_release);
+        throw;
+    }
+    PendingPushes.fetch_sub(1, std::memory_order_release);
+    // Будим владельца, только если он успел заснуть: в горячем пути мьютекс не берется
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (Sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(WakeupMutex);
+        Wakeup.notify_one();
+    }
+}
+
+void TAsyncBookingSystem::Run() {
+    while (true) {
+        if (ProcessBatch() > 0) {
+            continue;
+        }
+        if (Stopping.load()) {
+            // запросы, поставленные до остановки, все равно должны получить ответ
+            while (PendingPushes.load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+            while (ProcessBatch() > 0) {
+            }
+            return;
+        }
+        WaitForRequests();
+    }
+}
+
+size_t TAsyncBookingSystem::ProcessBatch() {
+    TRACE_SPAN("AsyncBookingSystem::ProcessBatch");
+    size_t processed = 0;
+    bool hasBookings = false;
+    while (processed < MaxBatchSize) {
+        auto request = Queue.Pop();
+        if (!request) {
+            break;
+        }
+        hasBookings |= request->Action == EAction::Book;
+        Process(*request);
+        ++processed;
+    }
+    if (hasBookings) {
+        PublishAvailability();
+    }
+    return processed;
+}
+
+void TAsyncBookingSystem::Process(TRequest& request) {
+    TCost result = 0;
+    try {
+        switch (request.Action) {
+            case EAction::Book:
+                result = BookingSystem.Book(request.Booking);
+                break;
+            case EAction::CheckInto:
+                result = BookingSystem.CheckInto(request.Booking);
+                break;
+            case EAction::GetBill:
+                result = BookingSystem.GetBill(request.Booking);
+                break;
+        }
+    } catch (...) {
+        request.Reply(0, std::current_exception());
+        return;
+    }
+    request.Reply(result, nullptr);
+}
+
+void TAsyncBookingSystem::PublishAvailability() {
+    TRACE_SPAN("AsyncBookingSystem::PublishAvailability");
+    if (Publisher) {
+        LastSnapshot = BookingSystem.MakeAvailabilitySnapshot(LastSnapshot.get());
+        Publisher->Publish(LastSnapshot);
+    }
+}
+
+void TAsyncBookingSystem::WaitForRequests() {
+    Sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(WakeupMutex);
+    Wakeup.wait(lock, [this] { return !Queue.IsEmpty() || Stopping.load(); });
+    Sleeping.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "availability.h"
+#include "booking_system.h"
+#include "mpsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+// Асинхронный фронтенд к системе бронирования.
+// Запросы от любого числа потоков складываются в неблокирующую очередь,
+// а единственный поток-владелец разбирает их пачками и последовательно
+// применяет к обернутой системе, поэтому сама система остается однопоточной.
+// Если задан publisher, после каждой пачки с бронированиями публикуется свежий снимок занятости.
+class TAsyncBookingSystem {
+public:
+    using TBookCallback = std::function<void(bool success)>;
+    using TBillCallback = std::function<void(TCost cost, bool success)>;
+
+public:
+    explicit TAsyncBookingSystem(
+        IBookingSystem& bookingSystem,
+        size_t maxBatchSize = 256,
+        TAvailabilityPublisher* publisher = nullptr
+    );
+    ~TAsyncBookingSystem();
+
+    TAsyncBookingSystem(const TAsyncBookingSystem&) = delete;
+    TAsyncBookingSystem& operator=(const TAsyncBookingSystem&) = delete;
+
+    std::future<bool> Book(const TBooking& booking);
+    std::future<bool> CheckInto(const TBooking& booking);
+    std::future<TCost> GetBill(const TBooking& booking);
+
+    // callback вызывается из потока-владельца, исключения из него не выпускаются.
+    // Если система бросила исключение, callback получает success = false.
+    void Book(const TBooking& booking, TBookCallback callback);
+    void CheckInto(const TBooking& booking, TBookCallback callback);
+    void GetBill(const TBooking& booking, TBillCallback callback);
+
+    // Дожидается обработки уже поставленных запросов и останавливает поток-владелец.
+    // Запрос, поставленный одновременно со Stop, либо будет обработан, либо Book бросит исключение.
+    void Stop();
+
+private:
+    enum class EAction {
+        Book,
+        CheckInto,
+        GetBill
+    };
+
+    using TReply = std::function<void(TCost result, std::exception_ptr error)>;
+
+    struct TRequest {
+        EAction Action;
+        TBooking Booking;
+        TReply Reply;
+    };
+
+private:
+    template <typename TResult>
+    std::future<TResult> Enqueue(EAction action, const TBooking& booking);
+    void Enqueue(EAction action, const TBooking& booking, TBillCallback callback);
+    void Enqueue(TRequest request);
+
+    void Run();
+    size_t ProcessBatch();
+    void Process(TRequest& request);
+    void PublishAvailability();
+    void WaitForRequests();
+
+private:
+    IBookingSystem& BookingSystem;
+    const size_t MaxBatchSize;
+    TAvailabilityPublisher* const Publisher;
+    // Последний опубликованный снимок, из него строится следующий
+    std::shared_ptr<const TAvailabilitySnapshot> LastSnapshot;
+
+    TMpscQueue<TRequest> Queue;
+    std::atomic_bool Stopping{false};
+    // Писатели, которые прошли проверку Stopping, но еще не дописали запрос в очередь
+    std::atomic<size_t> PendingPushes{0};
+    std::atomic_bool Sleeping{false};
+    std::mutex WakeupMutex;
+    std::condition_variable Wakeup;
+    std::thread Owner;
+};
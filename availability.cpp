@@ -0,0 +1,70 @@
+#include "availability.h"
+#include <algorithm>
+#include <stdexcept>
+
+TAvailabilitySnapshot::TAvailabilitySnapshot(
+    uint64_t version,
+    unsigned firstDay,
+    TRoomCounts roomCounts,
+    TRoomTypeMap<TChunks> busyRooms
+)
+    : Version(version)
+    , FirstDay(firstDay)
+    , RoomCounts(std::move(roomCounts))
+    , BusyRooms(std::move(busyRooms))
+{
+}
+
+std::shared_ptr<TAvailabilitySnapshot::TChunk> TAvailabilitySnapshot::MakeChunk() {
+    using TAllocator = TTrackingAllocator<TChunk, EMemoryComponent::AvailabilitySnapshots>;
+    return std::allocate_shared<TChunk>(TAllocator());
+}
+
+const std::shared_ptr<const TAvailabilitySnapshot::TChunk>* TAvailabilitySnapshot::FindChunk(ERoomType roomType, size_t chunk) const {
+    const auto& chunks = BusyRooms.at(roomType);
+    const size_t firstChunk = FirstDay / DAYS_IN_CHUNK;
+    if (chunk < firstChunk || chunk - firstChunk >= chunks.size()) {
+        return nullptr;
+    }
+    return &chunks[chunk - firstChunk];
+}
+
+unsigned TAvailabilitySnapshot::GetFreeRooms(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const {
+    if (dayTo < dayFrom || dayFrom < FirstDay) {
+        return 0;
+    }
+    const auto& chunks = BusyRooms.at(roomType);
+    const auto roomCount = RoomCounts.at(roomType);
+    const size_t firstChunk = FirstDay / DAYS_IN_CHUNK;
+    // за пределами снимка бронирований нет
+    const auto from = static_cast<size_t>(dayFrom) - firstChunk * DAYS_IN_CHUNK;
+    const auto to = std::min<size_t>(static_cast<size_t>(dayTo) - firstChunk * DAYS_IN_CHUNK + 1, chunks.size() * DAYS_IN_CHUNK);
+    unsigned maxBusy = 0;
+    for (auto day = from; day < to; ++day) {
+        maxBusy = std::max(maxBusy, (*chunks[day / DAYS_IN_CHUNK])[day % DAYS_IN_CHUNK]);
+    }
+    return maxBusy < roomCount ? roomCount - maxBusy : 0;
+}
+
+void TAvailabilityPublisher::Publish(std::shared_ptr<const TAvailabilitySnapshot> snapshot) {
+    if (!snapshot) {
+        throw std::runtime_error("Can't publish empty availability snapshot");
+    }
+    const auto version = snapshot->GetVersion();
+    Current.store(std::move(snapshot), std::memory_order_release);
+    Version.store(version, std::memory_order_release);
+}
+
+std::shared_ptr<const TAvailabilitySnapshot> TAvailabilityPublisher::Get() const {
+    return Current.load(std::memory_order_acquire);
+}
+
+const TAvailabilitySnapshot& TAvailabilityReader::GetSnapshot() {
+    if (!Snapshot || Snapshot->GetVersion() != Publisher.GetVersion()) {
+        Snapshot = Publisher.Get();
+        if (!Snapshot) {
+            throw std::runtime_error("Availability snapshot is not published yet");
+        }
+    }
+    return *Snapshot;
+}
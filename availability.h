@@ -0,0 +1,95 @@
+#pragma once
+
+#include "booking_system.h"
+#include "memory_accounting.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Неизменяемый снимок занятости номеров начиная с дня FirstDay.
+// После публикации не меняется, поэтому читается из любых потоков без синхронизации.
+// Занятость хранится кусками по DAYS_IN_CHUNK дней, выровненными по абсолютному номеру дня.
+// Куски неизменяемы, поэтому следующий снимок берет из предыдущего все куски,
+// в которых не было бронирований, и строит заново только остальные.
+class TAvailabilitySnapshot {
+public:
+    static constexpr unsigned DAYS_IN_CHUNK = 64;
+
+    // Число занятых номеров одного типа в дни [c * DAYS_IN_CHUNK, (c + 1) * DAYS_IN_CHUNK)
+    using TChunk = std::array<unsigned, DAYS_IN_CHUNK>;
+    using TChunks = TTrackedVector<std::shared_ptr<const TChunk>, EMemoryComponent::AvailabilitySnapshots>;
+
+public:
+    // busyRooms[t][c] - кусок номер firstDay / DAYS_IN_CHUNK + c для типа t
+    TAvailabilitySnapshot(
+        uint64_t version,
+        unsigned firstDay,
+        TRoomCounts roomCounts,
+        TRoomTypeMap<TChunks> busyRooms
+    );
+
+    static std::shared_ptr<TChunk> MakeChunk();
+
+    uint64_t GetVersion() const {
+        return Version;
+    }
+
+    unsigned GetFirstDay() const {
+        return FirstDay;
+    }
+
+    // Кусок с абсолютным номером chunk или nullptr, если его нет в снимке
+    const std::shared_ptr<const TChunk>* FindChunk(ERoomType roomType, size_t chunk) const;
+
+    // Сколько номеров данного типа свободно во все дни отрезка [dayFrom, dayTo].
+    // Дни раньше FirstDay уже прошли, свободных номеров в них нет.
+    unsigned GetFreeRooms(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const;
+
+private:
+    const uint64_t Version;
+    const unsigned FirstDay;
+    const TRoomCounts RoomCounts;
+    const TRoomTypeMap<TChunks> BusyRooms;
+};
+
+// Точка публикации снимков в духе RCU: писатель целиком подменяет текущий снимок,
+// а читатели продолжают работать со старым, пока не возьмут новый.
+// Get идет через std::atomic<std::shared_ptr>, которая в libstdc++ не lock-free:
+// чтение и подмена указателя коротко захватывают спин-блокировку в самом указателе.
+// Поэтому ожидание без блокировок дает только TAvailabilityReader, пока версия не меняется.
+class TAvailabilityPublisher {
+public:
+    void Publish(std::shared_ptr<const TAvailabilitySnapshot> snapshot);
+
+    std::shared_ptr<const TAvailabilitySnapshot> Get() const;
+
+    uint64_t GetVersion() const {
+        return Version.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<std::shared_ptr<const TAvailabilitySnapshot>> Current;
+    std::atomic<uint64_t> Version{0};
+};
+
+// Читатель для одного потока. Держит последний взятый снимок и перечитывает его
+// только после публикации новой версии, так что обычный запрос не трогает общих данных,
+// кроме одного атомарного счетчика, и завершается за конечное число шагов (wait-free).
+class TAvailabilityReader {
+public:
+    explicit TAvailabilityReader(const TAvailabilityPublisher& publisher)
+        : Publisher(publisher)
+    {
+    }
+
+    const TAvailabilitySnapshot& GetSnapshot();
+
+    unsigned GetFreeRooms(ERoomType roomType, unsigned dayFrom, unsigned dayTo) {
+        return GetSnapshot().GetFreeRooms(roomType, dayFrom, dayTo);
+    }
+
+private:
+    const TAvailabilityPublisher& Publisher;
+    std::shared_ptr<const TAvailabilitySnapshot> Snapshot;
+};
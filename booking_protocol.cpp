@@ -0,0 +1,70 @@
+#include "booking_protocol.h"
+
+namespace {
+    void WriteUint32(uint32_t value, std::string& out) {
+        for (size_t i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    uint32_t ReadUint32(const char* data) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+}
+
+void SerializeRequest(const TBookingRequest& request, std::string& out) {
+    out.push_back(static_cast<char>(request.Op));
+    out.push_back(static_cast<char>(request.Booking.RoomType));
+    out.append(2, '\0');
+    WriteUint32(request.RequestId, out);
+    WriteUint32(request.Booking.UserId, out);
+    WriteUint32(request.Booking.DayFrom, out);
+    WriteUint32(request.Booking.DayTo, out);
+}
+
+void SerializeResponse(const TBookingResponse& response, std::string& out) {
+    WriteUint32(response.RequestId, out);
+    out.push_back(static_cast<char>(response.Status));
+    out.append(3, '\0');
+    WriteUint32(response.Value, out);
+}
+
+TBookingRequest ParseRequest(const char* data) {
+    TBookingRequest request;
+    request.Op = static_cast<EBookingOp>(static_cast<uint8_t>(data[0]));
+    request.Booking.RoomType = static_cast<ERoomType>(static_cast<uint8_t>(data[1]));
+    request.RequestId = ReadUint32(data + 4);
+    request.Booking.UserId = ReadUint32(data + 8);
+    request.Booking.DayFrom = ReadUint32(data + 12);
+    request.Booking.DayTo = ReadUint32(data + 16);
+    return request;
+}
+
+TBookingResponse ParseResponse(const char* data) {
+    TBookingResponse response;
+    response.RequestId = ReadUint32(data);
+    response.Status = static_cast<EBookingStatus>(static_cast<uint8_t>(data[4]));
+    response.Value = ReadUint32(data + 8);
+    return response;
+}
+
+bool IsValidRequest(const TBookingRequest& request, const TBookingLimits& limits) {
+    switch (request.Op) {
+        case EBookingOp::Book:
+        case EBookingOp::CheckInto:
+        case EBookingOp::GetBill:
+        case EBookingOp::GetFreeRooms:
+            break;
+        default:
+            return false;
+    }
+    const auto& booking = request.Booking;
+    return static_cast<size_t>(booking.RoomType) < ROOM_TYPES.size()
+        && booking.DayFrom <= booking.DayTo
+        && booking.DayTo < limits.HorizonDays
+        && booking.DayTo - booking.DayFrom < limits.MaxStayDays;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "booking_system.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Бинарный протокол сервера бронирования. Кадры фиксированной длины, числа little-endian.
+// Клиент может слать запросы подряд, не дожидаясь ответов; ответ несет RequestId запроса
+// и может прийти раньше ответов на предыдущие запросы того же соединения.
+enum class EBookingOp : uint8_t {
+    Book = 1,
+    CheckInto = 2,
+    GetBill = 3,
+    // Сколько номеров типа RoomType свободно во все дни [DayFrom, DayTo]
+    GetFreeRooms = 4
+};
+
+enum class EBookingStatus : uint8_t {
+    Ok = 0,
+    Rejected = 1,
+    BadRequest = 2
+};
+
+struct TBookingRequest {
+    EBookingOp Op = EBookingOp::Book;
+    uint32_t RequestId = 0;
+    TBooking Booking = {};
+};
+
+struct TBookingResponse {
+    uint32_t RequestId = 0;
+    EBookingStatus Status = EBookingStatus::Ok;
+    // Счет для GetBill, число номеров для GetFreeRooms
+    uint32_t Value = 0;
+};
+
+// op:1 room_type:1 reserved:2 request_id:4 user_id:4 day_from:4 day_to:4
+constexpr size_t BOOKING_REQUEST_SIZE = 20;
+// request_id:4 status:1 reserved:3 value:4
+constexpr size_t BOOKING_RESPONSE_SIZE = 12;
+
+// Дописывают кадр в конец out
+void SerializeRequest(const TBookingRequest& request, std::string& out);
+void SerializeResponse(const TBookingResponse& response, std::string& out);
+
+// data указывает на полный кадр. Неизвестные операции и типы номеров не проверяются,
+// это делает IsValidRequest.
+TBookingRequest ParseRequest(const char* data);
+TBookingResponse ParseResponse(const char* data);
+
+// Какие дни сервер принимает в запросах. Время сервера стоит на нулевом дне,
+// поэтому горизонт отсчитывается от него. Без ограничений один запрос с DayTo около UINT_MAX
+// надолго занимает поток-владелец и раздувает план и снимки занятости.
+struct TBookingLimits {
+    // Все дни запроса меньше HorizonDays
+    unsigned HorizonDays = 2 * 365;
+    // Не больше MaxStayDays дней от DayFrom до DayTo включительно
+    unsigned MaxStayDays = 90;
+};
+
+bool IsValidRequest(const TBookingRequest& request, const TBookingLimits& limits);
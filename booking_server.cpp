@@ -0,0 +1,316 @@
+#include "booking_server.h"
+#include "trace.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    // Идентификаторы в epoll_event.data.u64; соединения нумеруются после них
+    constexpr uint64_t LISTENER_ID = 0;
+    constexpr uint64_t WAKEUP_ID = 1;
+
+    constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+    // Пока столько ответов не ушло в сокет, новые запросы соединения не читаются
+    constexpr size_t MAX_OUTPUT_SIZE = 1 << 20;
+    constexpr int MAX_EVENTS = 256;
+    // Через сколько снова пробовать accept4, если его остановила нехватка ресурсов, а соединения не закрываются
+    constexpr int ACCEPT_RETRY_MS = 100;
+
+    [[noreturn]] void ThrowErrno(const std::string& what) {
+        throw std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    void AddToEpoll(int epoll, int fd, uint64_t id, uint32_t events) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.u64 = id;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ThrowErrno("epoll_ctl");
+        }
+    }
+}
+
+TBookingServer::TBookingServer(
+    IBookingSystem& bookingSystem,
+    const TSocketAddress& address,
+    size_t maxBatchSize,
+    const TBookingLimits& limits
+)
+    : Limits(limits)
+    , Listener(Listen(address))
+    , Epoll(epoll_create1(EPOLL_CLOEXEC))
+    , WakeupEvent(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , NextConnectionId(WAKEUP_ID + 1)
+    , AvailabilityReader(Publisher)
+    , BookingSystem(bookingSystem, maxBatchSize, &Publisher)
+{
+    if (!Epoll) {
+        ThrowErrno("epoll_create1");
+    }
+    if (!WakeupEvent) {
+        ThrowErrno("eventfd");
+    }
+    AddToEpoll(Epoll.Get(), Listener.Get(), LISTENER_ID, EPOLLIN);
+    AddToEpoll(Epoll.Get(), WakeupEvent.Get(), WAKEUP_ID, EPOLLIN);
+}
+
+TBookingServer::~TBookingServer() {
+    BookingSystem.Stop();
+}
+
+void TBookingServer::Run() {
+    epoll_event events[MAX_EVENTS];
+    while (!Stopping.load()) {
+        const auto count = epoll_wait(Epoll.Get(), events, MAX_EVENTS, AcceptPaused ? ACCEPT_RETRY_MS : -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("epoll_wait");
+        }
+        if (count == 0) {
+            ResumeAccept();
+            continue;
+        }
+        TRACE_SPAN("BookingServer::HandleEvents");
+        for (int i = 0; i < count; ++i) {
+            const auto id = events[i].data.u64;
+            if (id == LISTENER_ID) {
+                Accept();
+                continue;
+            }
+            if (id == WAKEUP_ID) {
+                DrainCompletions();
+                continue;
+            }
+            auto it = Connections.find(id);
+            if (it == Connections.end()) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                Close(id);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                PendingWrites.push_back(id);
+            }
+            if (events[i].events & EPOLLIN) {
+                Read(id, it->second);
+            }
+        }
+        // Все ответы, накопленные за итерацию, уходят одной записью на соединение
+        for (const auto id : PendingWrites) {
+            auto it = Connections.find(id);
+            if (it != Connections.end()) {
+                Write(id, it->second);
+            }
+        }
+        PendingWrites.clear();
+    }
+    Connections.clear();
+}
+
+void TBookingServer::Stop() {
+    Stopping.store(true);
+    Signal();
+}
+
+void TBookingServer::Accept() {
+    while (true) {
+        TFileDescriptor socket(accept4(Listener.Get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC));
+        if (!socket) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // Кончились дескрипторы или память: ожидающие соединения остаются в очереди ядра,
+            // а сервер перестает их принимать, пока не закроется соединение или не пройдет ACCEPT_RETRY_MS
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                PauseAccept();
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ThrowErrno("accept4");
+            }
+            return;
+        }
+        AcceptErrorReported = false;
+        SetNoDelay(socket.Get());
+        const auto id = NextConnectionId++;
+        AddToEpoll(Epoll.Get(), socket.Get(), id, EPOLLIN);
+        auto& connection = Connections[id];
+        connection.Socket = std::move(socket);
+        connection.Events = EPOLLIN;
+    }
+}
+
+void TBookingServer::PauseAccept() {
+    // одно сообщение, пока снова не удастся принять соединение
+    if (!AcceptErrorReported) {
+        std::cerr << "accept4: " << std::strerror(errno) << ", not accepting new connections for a while" << std::endl;
+        AcceptErrorReported = true;
+    }
+    SetListenerEvents(0);
+    AcceptPaused = true;
+}
+
+void TBookingServer::ResumeAccept() {
+    if (!AcceptPaused) {
+        return;
+    }
+    SetListenerEvents(EPOLLIN);
+    AcceptPaused = false;
+}
+
+void TBookingServer::SetListenerEvents(uint32_t events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.u64 = LISTENER_ID;
+    if (epoll_ctl(Epoll.Get(), EPOLL_CTL_MOD, Listener.Get(), &event) < 0) {
+        ThrowErrno("epoll_ctl");
+    }
+}
+
+void TBookingServer::Read(uint64_t connectionId, TConnection& connection) {
+    char buffer[READ_CHUNK_SIZE];
+    while (connection.Output.size() < MAX_OUTPUT_SIZE) {
+        const auto size = recv(connection.Socket.Get(), buffer, sizeof(buffer), 0);
+        if (size == 0 || (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            Close(connectionId);
+            return;
+        }
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        connection.Input.append(buffer, size);
+
+        size_t offset = 0;
+        for (; offset + BOOKING_REQUEST_SIZE <= connection.Input.size(); offset += BOOKING_REQUEST_SIZE) {
+            Handle(connectionId, connection, ParseRequest(connection.Input.data() + offset));
+        }
+        connection.Input.erase(0, offset);
+    }
+    UpdateEvents(connectionId, connection);
+}
+
+void TBookingServer::Handle(uint64_t connectionId, TConnection& connection, const TBookingRequest& request) {
+    const auto requestId = request.RequestId;
+    if (!IsValidRequest(request, Limits)) {
+        SerializeResponse({requestId, EBookingStatus::BadRequest, 0}, connection.Output);
+        PendingWrites.push_back(connectionId);
+        return;
+    }
+
+    auto reply = [this, connectionId, requestId](bool success) {
+        Complete(connectionId, {requestId, success ? EBookingStatus::Ok : EBookingStatus::Rejected, 0});
+    };
+    switch (request.Op) {
+        case EBookingOp::Book:
+            BookingSystem.Book(request.Booking, std::move(reply));
+            break;
+        case EBookingOp::CheckInto:
+            BookingSystem.CheckInto(request.Booking, std::move(reply));
+            break;
+        case EBookingOp::GetBill:
+            BookingSystem.GetBill(request.Booking, [this, connectionId, requestId](TCost cost, bool success) {
+                Complete(connectionId, {requestId, success ? EBookingStatus::Ok : EBookingStatus::BadRequest, cost});
+            });
+            break;
+        case EBookingOp::GetFreeRooms: {
+            const auto& booking = request.Booking;
+            const auto freeRooms = AvailabilityReader.GetFreeRooms(booking.RoomType, booking.DayFrom, booking.DayTo);
+            SerializeResponse({requestId, EBookingStatus::Ok, freeRooms}, connection.Output);
+            PendingWrites.push_back(connectionId);
+            break;
+        }
+    }
+}
+
+void TBookingServer::Complete(uint64_t connectionId, const TBookingResponse& response) {
+    Completions.Push({connectionId, response});
+    // eventfd пишется, только если цикл еще не разбужен предыдущими ответами
+    if (!Signaled.exchange(true)) {
+        Signal();
+    }
+}
+
+void TBookingServer::DrainCompletions() {
+    uint64_t value = 0;
+    while (read(WakeupEvent.Get(), &value, sizeof(value)) < 0 && errno == EINTR) {
+    }
+    // Сбрасываем флаг до разбора очереди: ответ, добавленный после, снова разбудит цикл
+    Signaled.store(false);
+    while (auto completion = Completions.Pop()) {
+        auto it = Connections.find(completion->ConnectionId);
+        if (it == Connections.end()) {
+            continue;
+        }
+        SerializeResponse(completion->Response, it->second.Output);
+        PendingWrites.push_back(completion->ConnectionId);
+    }
+}
+
+void TBookingServer::Write(uint64_t connectionId, TConnection& connection) {
+    size_t offset = 0;
+    while (offset < connection.Output.size()) {
+        const auto size = send(
+            connection.Socket.Get(),
+            connection.Output.data() + offset,
+            connection.Output.size() - offset,
+            MSG_NOSIGNAL
+        );
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            Close(connectionId);
+            return;
+        }
+        offset += size;
+    }
+    connection.Output.erase(0, offset);
+    UpdateEvents(connectionId, connection);
+}
+
+void TBookingServer::UpdateEvents(uint64_t connectionId, TConnection& connection) {
+    uint32_t events = 0;
+    if (connection.Output.size() < MAX_OUTPUT_SIZE) {
+        events |= EPOLLIN;
+    }
+    if (!connection.Output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events == connection.Events) {
+        return;
+    }
+    epoll_event event = {};
+    event.events = events;
+    event.data.u64 = connectionId;
+    if (epoll_ctl(Epoll.Get(), EPOLL_CTL_MOD, connection.Socket.Get(), &event) < 0) {
+        ThrowErrno("epoll_ctl");
+    }
+    connection.Events = events;
+}
+
+void TBookingServer::Close(uint64_t connectionId) {
+    // Закрытие дескриптора убирает его из epoll; опоздавшие ответы отбрасывает DrainCompletions
+    Connections.erase(connectionId);
+    // освободился дескриптор, можно снова принимать соединения
+    ResumeAccept();
+}
+
+void TBookingServer::Signal() {
+    const uint64_t value = 1;
+    while (write(WakeupEvent.Get(), &value, sizeof(value)) < 0 && errno == EINTR) {
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "async_booking_system.h"
+#include "availability.h"
+#include "booking_protocol.h"
+#include "mpsc_queue.h"
+#include "socket_utils.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Сервер бронирования на epoll.
+// Один поток цикла событий читает кадры из всех соединений и сразу отправляет их
+// в TAsyncBookingSystem, не дожидаясь ответов на предыдущие, а GetFreeRooms отвечает
+// сам по опубликованному снимку занятости. Ответы владельца системы возвращаются
+// в цикл через очередь и eventfd и уходят в сокет одной записью на итерацию цикла.
+class TBookingServer {
+public:
+    // Запросы с днями за пределами limits получают BadRequest и до системы не доходят
+    TBookingServer(
+        IBookingSystem& bookingSystem,
+        const TSocketAddress& address,
+        size_t maxBatchSize = 256,
+        const TBookingLimits& limits = {}
+    );
+    ~TBookingServer();
+
+    TBookingServer(const TBookingServer&) = delete;
+    TBookingServer& operator=(const TBookingServer&) = delete;
+
+    // Обслуживает соединения, пока не вызван Stop
+    void Run();
+    // Можно вызывать из любого потока и из обработчика сигнала
+    void Stop();
+
+private:
+    struct TConnection {
+        TFileDescriptor Socket;
+        std::string Input;
+        std::string Output;
+        uint32_t Events = 0;
+    };
+
+    struct TCompletion {
+        uint64_t ConnectionId;
+        TBookingResponse Response;
+    };
+
+private:
+    void Accept();
+    void PauseAccept();
+    void ResumeAccept();
+    void SetListenerEvents(uint32_t events);
+    void Read(uint64_t connectionId, TConnection& connection);
+    void Handle(uint64_t connectionId, TConnection& connection, const TBookingRequest& request);
+    void Complete(uint64_t connectionId, const TBookingResponse& response);
+    void DrainCompletions();
+    void Write(uint64_t connectionId, TConnection& connection);
+    void UpdateEvents(uint64_t connectionId, TConnection& connection);
+    void Close(uint64_t connectionId);
+    void Signal();
+
+private:
+    const TBookingLimits Limits;
+    TFileDescriptor Listener;
+    TFileDescriptor Epoll;
+    TFileDescriptor WakeupEvent;
+    std::atomic_bool Stopping{false};
+    std::atomic_bool Signaled{false};
+    // accept4 не удался из-за нехватки дескрипторов или памяти, слушающий сокет убран из epoll
+    bool AcceptPaused = false;
+    bool AcceptErrorReported = false;
+
+    std::unordered_map<uint64_t, TConnection> Connections;
+    uint64_t NextConnectionId;
+    // Соединения, в которые за итерацию добавились ответы
+    std::vector<uint64_t> PendingWrites;
+
+    TMpscQueue<TCompletion> Completions;
+    TAvailabilityPublisher Publisher;
+    TAvailabilityReader AvailabilityReader;
+    // Объявлена последней: поток-владелец пишет в Completions и должен остановиться раньше
+    TAsyncBookingSystem BookingSystem;
+};
@@ -1,84 +1,34 @@
 #include "booking_system.h"
 #include "clock.h"
+#include "hotel_plan.h"
+#include "memory_accounting.h"
+#include <algorithm>
 #include <string>
-#include <thread>
-#include <unordered_set>
-#include <vector>
 
 namespace {
-    class THotelPlan {
-    public:
-        explicit THotelPlan(TRoomCounts roomCounts)
-            : RoomCounts(std::move(roomCounts))
-        {
-            for (const auto roomType : ROOM_TYPES) {
-                if (!RoomCounts.count(roomType)) {
-                    throw std::runtime_error("Room count is not set for type " + RoomTypeToString(roomType));
-                }
-            }
-            for (const auto roomType : ROOM_TYPES) {
-                BusyRooms[roomType];
-            }
-        }
-
-        bool Has(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const {
-            if (RoomCounts.at(roomType) == 0) {
-                return false;
-            }
-            for (unsigned day = dayFrom; day <= dayTo; ++day) {
-                if (!BusyRooms.at(roomType).count(day)) {
-                    continue;
-                }
-                if (BusyRooms.at(roomType).at(day).size() == RoomCounts.at(roomType)) {
-                    return false;
-                }
-            }
-            return true;
-        }
-
-        void Book(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) {
-            for (unsigned day = dayFrom; day <= dayTo; ++day) {
-                BusyRooms[roomType][day];
-                if (BusyRooms.at(roomType).at(day).size() == RoomCounts.at(roomType)) {
-                    throw std::runtime_error(
-                        "All rooms of type " + std::to_string(static_cast<int>(roomType)) +
-                        " are busy at " + std::to_string(day) + " day"
-                    );
-                }
-                BusyRooms[roomType][day].insert(userId);
-            }
+    bool ReleaseRoom(IHotelPlan& hotelPlan, const TBooking& booking, ERoomType roomType, unsigned dayFrom) {
+        if (dayFrom < booking.DayFrom || dayFrom > booking.DayTo) {
+            return false;
         }
-
-        bool HasBooking(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) const {
-            for (unsigned day = dayFrom; day <= dayTo; ++day) {
-                if (!BusyRooms.at(roomType).count(day)) {
-                    return false;
-                }
-                if (BusyRooms.at(roomType).at(day).count(userId) == 0) {
-                    return false;
-                }
-            }
-            return true;
+        if (!hotelPlan.HasBooking(booking.UserId, roomType, dayFrom, booking.DayTo)) {
+            return false;
         }
-
-    private:
-        const TRoomCounts RoomCounts;
-        // room type, date, busy rooms count
-        std::unordered_map<ERoomType, std::unordered_map<unsigned, std::unordered_set<TUserId>>> BusyRooms;
-    };
+        hotelPlan.Release(booking.UserId, roomType, dayFrom, booking.DayTo);
+        return true;
+    }
 
     class TTrivialBookingSystem : public IBookingSystem {
     public:
-        TTrivialBookingSystem(TRoomCounts roomCounts, TRoomCosts roomCosts, const IClock& clock)
-            : HotelPlan(std::move(roomCounts))
+        TTrivialBookingSystem(TRoomCounts roomCounts, TRoomCosts roomCosts, const IClock& clock, EPlanType planType)
+            : HotelPlan(IHotelPlan::Create(std::move(roomCounts), planType))
             , RoomCosts(std::move(roomCosts))
             , Clock(clock)
         {
         }
 
         bool Book(const TBooking& booking) override {
-            if (HotelPlan.Has(booking.RoomType, booking.DayFrom, booking.DayTo)) {
-                HotelPlan.Book(booking.UserId, booking.RoomType, booking.DayFrom, booking.DayTo);
+            if (HotelPlan->Has(booking.RoomType, booking.DayFrom, booking.DayTo)) {
+                HotelPlan->Book(booking.UserId, booking.RoomType, booking.DayFrom, booking.DayTo);
                 return true;
             }
             return false;
@@ -92,7 +42,7 @@ namespace {
             if (currentDate < booking.DayFrom || currentDate > booking.DayTo) {
                 return false;
             }
-            if (HotelPlan.HasBooking(booking.UserId, booking.RoomType, currentDate, booking.DayTo)) {
+            if (HotelPlan->HasBooking(booking.UserId, booking.RoomType, currentDate, booking.DayTo)) {
                 return true;
             }
             return false;
@@ -102,29 +52,54 @@ namespace {
             return RoomCosts.at(booking.RoomType);
         }
 
+        bool Release(const TBooking& booking, unsigned dayFrom) override {
+            return ReleaseRoom(*HotelPlan, booking, booking.RoomType, dayFrom);
+        }
+
+        ERoomType GetBookedRoomType(const TBooking& booking) const override {
+            return booking.RoomType;
+        }
+
+        std::shared_ptr<const TAvailabilitySnapshot> MakeAvailabilitySnapshot(const TAvailabilitySnapshot* previous) const override {
+            return HotelPlan->MakeAvailabilitySnapshot(Clock.GetTime().Day, previous);
+        }
+
     private:
-        THotelPlan HotelPlan;
+        std::unique_ptr<IHotelPlan> HotelPlan;
         TRoomCosts RoomCosts;
         const IClock& Clock;
     };
 
-    std::vector<ERoomType> GetSuitableRoomTypes(ERoomType roomType) {
-        auto it = std::find(std::begin(ROOM_TYPES), std::end(ROOM_TYPES), roomType);
-        if (it == std::end(ROOM_TYPES)) {
-            throw std::runtime_error("Invalid value of enum ERoomType");
+    // Типы номеров, в которые можно поселить гостя: забронированный и все следующие за ним
+    struct TRoomTypeChain {
+        const ERoomType* Begin;
+        const ERoomType* End;
+
+        constexpr const ERoomType* begin() const {
+            return Begin;
         }
-        std::vector<ERoomType> result;
-        while (it != std::end(ROOM_TYPES)) {
-            result.push_back(*it);
-            ++it;
+
+        constexpr const ERoomType* end() const {
+            return End;
+        }
+    };
+
+    constexpr auto SUITABLE_ROOM_TYPES = [] {
+        TRoomTypeMap<TRoomTypeChain> result;
+        for (const auto roomType : ROOM_TYPES) {
+            result[roomType] = {ROOM_TYPES.data() + static_cast<size_t>(roomType), ROOM_TYPES.data() + ROOM_TYPES.size()};
         }
         return result;
+    }();
+
+    constexpr TRoomTypeChain GetSuitableRoomTypes(ERoomType roomType) {
+        return SUITABLE_ROOM_TYPES.at(roomType);
     }
 
     class TSmartBookingSystem : public IBookingSystem {
     public:
-        TSmartBookingSystem(TRoomCounts roomCounts, TRoomCosts roomCosts, const IClock& clock)
-            : HotelPlan(std::move(roomCounts))
+        TSmartBookingSystem(TRoomCounts roomCounts, TRoomCosts roomCosts, const IClock& clock, EPlanType planType)
+            : HotelPlan(IHotelPlan::Create(std::move(roomCounts), planType))
             , RoomCosts(std::move(roomCosts))
             , Clock(clock)
         {
@@ -133,8 +108,14 @@ namespace {
         bool Book(const TBooking& booking) override {
             const auto suitableRoomTypes = GetSuitableRoomTypes(booking.RoomType);
             for (const auto roomType : suitableRoomTypes) {
-                if (HotelPlan.Has(roomType, booking.DayFrom, booking.DayTo)) {
-                    HotelPlan.Book(booking.UserId, roomType, booking.DayFrom, booking.DayTo);
+                if (HotelPlan->Has(roomType, booking.DayFrom, booking.DayTo)) {
+                    const auto assignment = Assignments.emplace(booking.UserId, TAssignment{booking.DayFrom, booking.DayTo, roomType});
+                    try {
+                        HotelPlan->Book(booking.UserId, roomType, booking.DayFrom, booking.DayTo);
+                    } catch (...) {
+                        Assignments.erase(assignment);
+                        throw;
+                    }
                     return true;
                 }
             }
@@ -152,7 +133,7 @@ namespace {
 
             const auto suitableRoomTypes = GetSuitableRoomTypes(booking.RoomType);
             auto hasBooking = [this, &booking, currentDate](ERoomType roomType) {
-                return HotelPlan.HasBooking(booking.UserId, roomType, currentDate, booking.DayTo);
+                return HotelPlan->HasBooking(booking.UserId, roomType, currentDate, booking.DayTo);
             };
             return std::any_of(std::begin(suitableRoomTypes), std::end(suitableRoomTypes), hasBooking);
 
@@ -163,10 +144,38 @@ namespace {
             return RoomCosts.at(booking.RoomType);
         }
 
+        bool Release(const TBooking& booking, unsigned dayFrom) override {
+            return ReleaseRoom(*HotelPlan, booking, GetBookedRoomType(booking), dayFrom);
+        }
+
+        ERoomType GetBookedRoomType(const TBooking& booking) const override {
+            const auto [begin, end] = Assignments.equal_range(booking.UserId);
+            for (auto it = begin; it != end; ++it) {
+                const auto& assignment = it->second;
+                if (assignment.DayFrom == booking.DayFrom && assignment.DayTo == booking.DayTo) {
+                    return assignment.RoomType;
+                }
+            }
+            return booking.RoomType;
+        }
+
+        std::shared_ptr<const TAvailabilitySnapshot> MakeAvailabilitySnapshot(const TAvailabilitySnapshot* previous) const override {
+            return HotelPlan->MakeAvailabilitySnapshot(Clock.GetTime().Day, previous);
+        }
+
+    private:
+        struct TAssignment {
+            unsigned DayFrom;
+            unsigned DayTo;
+            ERoomType RoomType;
+        };
+
     private:
-        THotelPlan HotelPlan;
+        std::unique_ptr<IHotelPlan> HotelPlan;
         TRoomCosts RoomCosts;
         const IClock& Clock;
+        // Тип номера, выданный каждому подтвержденному бронированию; у гостя их может быть несколько
+        TTrackedUnorderedMultimap<TUserId, TAssignment, EMemoryComponent::HotelPlan> Assignments;
     };
 }
 
@@ -182,12 +191,13 @@ std::unique_ptr<IBookingSystem> IBookingSystem::Create(
     TRoomCounts roomCounts,
     TRoomCosts roomCosts,
     IBookingSystem::EType type,
-    const IClock& clock
+    const IClock& clock,
+    IBookingSystem::EPlanType planType
 ) {
     switch (type) {
         case IBookingSystem::EType::Trivial:
-            return std::make_unique<TTrivialBookingSystem>(std::move(roomCounts), std::move(roomCosts), clock);
+            return std::make_unique<TTrivialBookingSystem>(std::move(roomCounts), std::move(roomCosts), clock, planType);
         case IBookingSystem::EType::Smart:
-            return std::make_unique<TSmartBookingSystem>(std::move(roomCounts), std::move(roomCosts), clock);
+            return std::make_unique<TSmartBookingSystem>(std::move(roomCounts), std::move(roomCosts), clock, planType);
     }
 }
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "clock.h"
+#include "enum_map.h"
 #include <array>
 #include <memory>
-#include <unordered_map>
+#include <string>
 
 #define ROOMS \
     X(Single) \
@@ -24,11 +25,23 @@ constexpr std::array ROOM_TYPES {
 #undef X
 };
 
+static_assert([] {
+    for (size_t i = 0; i < ROOM_TYPES.size(); ++i) {
+        if (static_cast<size_t>(ROOM_TYPES[i]) != i) {
+            return false;
+        }
+    }
+    return true;
+}(), "ROOM_TYPES must list ERoomType values in order");
+
+template <typename TValue>
+using TRoomTypeMap = TEnumMap<ERoomType, ROOM_TYPES.size(), TValue>;
+
 std::string RoomTypeToString(ERoomType roomType);
 
-using TRoomCounts = std::unordered_map<ERoomType, unsigned>;
+using TRoomCounts = TRoomTypeMap<unsigned>;
 using TCost = unsigned;
-using TRoomCosts = std::unordered_map<ERoomType, TCost>;
+using TRoomCosts = TRoomTypeMap<TCost>;
 using TUserId = unsigned;
 
 struct TBooking {
@@ -38,6 +51,8 @@ struct TBooking {
     unsigned DayTo;
 };
 
+class TAvailabilitySnapshot;
+
 // Отвечает за стратегию бронироования номеров
 class IBookingSystem {
 public:
@@ -46,13 +61,35 @@ public:
         Smart
     };
 
+    // Представление плана занятости: Hash - множества гостей по дням,
+    // Bitset - битовые слои занятости, выгоднее при небольшом числе номеров каждого типа.
+    // Правила бронирования у обоих одинаковые, решения тоже.
+    enum class EPlanType {
+        Hash,
+        Bitset
+    };
+
 public:
     virtual ~IBookingSystem() = default;
 
     virtual bool Book(const TBooking& booking) = 0;
     virtual bool CheckInto(const TBooking& booking) = 0;
     virtual TCost GetBill(const TBooking& booking) = 0;
+    // Гость по подтвержденному бронированию освобождает номер с дня dayFrom до конца брони:
+    // уехал раньше или не приехал. false, если номер в эти дни за ним не числится.
+    virtual bool Release(const TBooking& booking, unsigned dayFrom) = 0;
+    // Тип номера, в который на самом деле поселят гостя по подтвержденному бронированию. O(1).
+    virtual ERoomType GetBookedRoomType(const TBooking& booking) const = 0;
+    // Снимок занятости начиная с текущего дня; не потокобезопасен, как и остальные методы.
+    // Если передан предыдущий снимок этой же системы, пересчитываются только изменившиеся дни.
+    virtual std::shared_ptr<const TAvailabilitySnapshot> MakeAvailabilitySnapshot(const TAvailabilitySnapshot* previous) const = 0;
 
 public:
-    static std::unique_ptr<IBookingSystem> Create(TRoomCounts roomCounts, TRoomCosts roomCosts, EType type, const IClock& clock);
+    static std::unique_ptr<IBookingSystem> Create(
+        TRoomCounts roomCounts,
+        TRoomCosts roomCosts,
+        EType type,
+        const IClock& clock,
+        EPlanType planType = EPlanType::Hash
+    );
 };
@@ -0,0 +1,14 @@
+#include "clock.h"
+
+namespace {
+    constexpr unsigned HOURS_IN_DAY = 24;
+}
+
+IClock::TTime TClock::GetTime() const {
+    const auto value = Hours.load();
+    return {value / HOURS_IN_DAY, value % HOURS_IN_DAY};
+}
+
+void TClock::Add(unsigned additionalHours) {
+    Hours += additionalHours;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 class IClock {
 public:
     struct TTime {
@@ -12,3 +14,14 @@ public:
 
     virtual TTime GetTime() const = 0;
 };
+
+// Часы эмуляции, которые идут только по команде Add
+class TClock : public IClock {
+public:
+    TTime GetTime() const override;
+
+    void Add(unsigned additionalHours);
+
+private:
+    std::atomic_uint Hours{0};
+};
@@ -0,0 +1,397 @@
+#include "coroutine_emulator.h"
+#include "day_queue.h"
+#include "emulator_base.h"
+#include "memory_accounting.h"
+#include "trace.h"
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+    constexpr unsigned HOURS_IN_DAY = 24;
+
+    // Пул кадров корутин. Все гости - одна и та же корутина, поэтому кадры одного размера
+    // и выдаются из больших плит через список свободных, без обращения к куче на каждого гостя.
+    // Перед кадром лежит указатель на пул, чтобы освобождение нашло его без параметров.
+    // Плиты и кадры из кучи засчитываются компоненту GuestFrames.
+    class TFramePool {
+    public:
+        static constexpr size_t FRAMES_PER_SLAB = 4096;
+        static constexpr auto MEMORY_COMPONENT = EMemoryComponent::GuestFrames;
+
+    public:
+        TFramePool() = default;
+        TFramePool(const TFramePool&) = delete;
+        TFramePool& operator=(const TFramePool&) = delete;
+
+        ~TFramePool() {
+            for (size_t i = 0; i < Slabs.size(); ++i) {
+                TMemoryAccounting::OnDeallocate(MEMORY_COMPONENT, BlockSize * FRAMES_PER_SLAB, FRAMES_PER_SLAB);
+            }
+        }
+
+        void* Allocate(size_t size) {
+            const auto blockSize = size + HEADER_SIZE;
+            if (BlockSize == 0) {
+                BlockSize = (blockSize + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+            }
+            std::byte* block = nullptr;
+            TFramePool* pool = this;
+            if (blockSize > BlockSize) {
+                // кадр другого размера пул не ждет, такой берется из кучи
+                TMemoryAccounting::OnAllocate(MEMORY_COMPONENT, blockSize, 1);
+                try {
+                    block = static_cast<std::byte*>(::operator new(blockSize));
+                } catch (...) {
+                    TMemoryAccounting::OnDeallocate(MEMORY_COMPONENT, blockSize, 1);
+                    throw;
+                }
+                pool = nullptr;
+            } else {
+                block = AllocateBlock();
+            }
+            *reinterpret_cast<TFramePool**>(block) = pool;
+            return block + HEADER_SIZE;
+        }
+
+        static void Deallocate(void* frame, size_t size) noexcept {
+            auto* block = static_cast<std::byte*>(frame) - HEADER_SIZE;
+            auto* pool = *reinterpret_cast<TFramePool**>(block);
+            if (!pool) {
+                ::operator delete(block);
+                TMemoryAccounting::OnDeallocate(MEMORY_COMPONENT, size + HEADER_SIZE, 1);
+                return;
+            }
+            auto* freeBlock = reinterpret_cast<TFreeBlock*>(block);
+            freeBlock->Next = pool->FreeBlocks;
+            pool->FreeBlocks = freeBlock;
+        }
+
+    private:
+        struct TFreeBlock {
+            TFreeBlock* Next;
+        };
+
+        // Заголовок занимает одно выравнивание, чтобы кадр остался выровненным как из operator new
+        static constexpr size_t HEADER_SIZE = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    private:
+        std::byte* AllocateBlock() {
+            if (FreeBlocks) {
+                auto* block = FreeBlocks;
+                FreeBlocks = block->Next;
+                return reinterpret_cast<std::byte*>(block);
+            }
+            if (Slabs.empty() || SlabUsed == FRAMES_PER_SLAB) {
+                const auto slabSize = BlockSize * FRAMES_PER_SLAB;
+                TMemoryAccounting::OnAllocate(MEMORY_COMPONENT, slabSize, FRAMES_PER_SLAB);
+                try {
+                    Slabs.push_back(std::make_unique<std::byte[]>(slabSize));
+                } catch (...) {
+                    TMemoryAccounting::OnDeallocate(MEMORY_COMPONENT, slabSize, FRAMES_PER_SLAB);
+                    throw;
+                }
+                SlabUsed = 0;
+            }
+            return Slabs.back().get() + BlockSize * SlabUsed++;
+        }
+
+    private:
+        size_t BlockSize = 0;
+        TTrackedVector<std::unique_ptr<std::byte[]>, MEMORY_COMPONENT> Slabs;
+        size_t SlabUsed = 0;
+        TFreeBlock* FreeBlocks = nullptr;
+    };
+
+    // Случайные числа одного гостя. Поток зависит только от зерна и номера гостя,
+    // поэтому при парном сравнении стратегий один и тот же гость ведет себя одинаково.
+    class TGuestRandom {
+    public:
+        TGuestRandom(uint64_t seed, TUserId userId)
+            : State(seed ^ (static_cast<uint64_t>(userId) * 0x9E3779B97F4A7C15ULL))
+        {
+        }
+
+        bool Happens(double probability) {
+            return probability > 0 && NextDouble() < probability;
+        }
+
+        // Равномерно из [from, to]
+        unsigned Uniform(unsigned from, unsigned to) {
+            return from + static_cast<unsigned>(Next() % (static_cast<uint64_t>(to) - from + 1));
+        }
+
+    private:
+        // splitmix64
+        uint64_t Next() {
+            auto z = (State += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        double NextDouble() {
+            return (Next() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        uint64_t State;
+    };
+
+    class TCoroutineEmulator;
+
+    // Корутина гостя. Начинает выполняться сразу и сама освобождает кадр, когда гость уезжает;
+    // кадры гостей, которые еще ждут, уничтожает эмулятор.
+    struct TGuest {
+        struct promise_type {
+            promise_type(TCoroutineEmulator& emulator, const TBooking& /*booking*/)
+                : Emulator(emulator)
+            {
+            }
+
+            // Кадр берется из пула эмулятора, который передается первым аргументом корутины
+            static void* operator new(size_t size, TCoroutineEmulator& emulator, const TBooking& booking);
+
+            static void operator delete(void* frame, size_t size) noexcept {
+                TFramePool::Deallocate(frame, size);
+            }
+
+            TGuest get_return_object() noexcept {
+                return {};
+            }
+
+            std::suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept {
+                return {};
+            }
+
+            void return_void() noexcept {
+            }
+
+            void unhandled_exception() noexcept;
+
+            TCoroutineEmulator& Emulator;
+        };
+    };
+
+    // Гости ждут нужного часа эмуляции в очередях по часам, один планировщик будит их в MakeStep.
+    // Как и в простом эмуляторе, в каждом часе сначала выезжают, потом заселяются.
+    class TCoroutineEmulator : public TEmulatorBase {
+    public:
+        TCoroutineEmulator(
+            const TContext& context,
+            std::unique_ptr<IDemandGenerator> demandGenerator,
+            const TGuestBehaviour& guestBehaviour
+        )
+            : TEmulatorBase(context, std::move(demandGenerator))
+            , Behaviour(guestBehaviour)
+            , CurrentDay(Context.Clock.GetTime().Day)
+            , NextHour(ToHour(Context.Clock.GetTime()))
+        {
+        }
+
+        ~TCoroutineEmulator() override {
+            // кадры ждущих гостей лежат в пуле, поэтому уничтожаются раньше него
+            for (; NextHour <= LastWakeupHour; ++NextHour) {
+                for (auto* wakeups : {&Departures, &Arrivals}) {
+                    wakeups->Consume(NextHour, [](std::coroutine_handle<> guest) {
+                        guest.destroy();
+                    });
+                }
+            }
+        }
+
+        void MakeStep() override {
+            TRACE_SPAN("Emulator::MakeStep");
+            const auto currentTime = Context.Clock.GetTime();
+            ResumeGuests(ToHour(currentTime));
+            for (; CurrentDay < currentTime.Day; ++CurrentDay) {
+                ObserveDayEnd(CurrentDay);
+            }
+            HandleBookings(currentTime);
+        }
+
+        void* AllocateFrame(size_t size) {
+            return FramePool.Allocate(size);
+        }
+
+        void SetError(std::exception_ptr error) {
+            Error = std::move(error);
+        }
+
+    private:
+        using TWakeups = TDayQueue<std::coroutine_handle<>>;
+
+        // Ожидание начала часа hour в очереди Wakeups
+        struct TWakeup {
+            TCoroutineEmulator& Emulator;
+            TWakeups& Wakeups;
+            unsigned Hour;
+
+            bool await_ready() const noexcept {
+                return Hour < Emulator.NextHour;
+            }
+
+            void await_suspend(std::coroutine_handle<> guest) {
+                Wakeups.Push(Hour, guest);
+                Emulator.LastWakeupHour = std::max(Emulator.LastWakeupHour, Hour);
+            }
+
+            void await_resume() const noexcept {
+            }
+        };
+
+    private:
+        static unsigned ToHour(IClock::TTime time) {
+            return time.Day * HOURS_IN_DAY + time.Hour;
+        }
+
+        TWakeup WaitForArrival(unsigned day) {
+            return {*this, Arrivals, day * HOURS_IN_DAY};
+        }
+
+        TWakeup WaitForDeparture(unsigned day) {
+            return {*this, Departures, day * HOURS_IN_DAY};
+        }
+
+        void ResumeGuests(unsigned currentHour) {
+            TRACE_SPAN("Emulator::ResumeGuests");
+            while (NextHour <= currentHour) {
+                const auto hour = NextHour++;
+                // дни, закончившиеся до этого часа, закрываются раньше его событий
+                for (; CurrentDay < hour / HOURS_IN_DAY; ++CurrentDay) {
+                    ObserveDayEnd(CurrentDay);
+                }
+                for (auto* wakeups : {&Departures, &Arrivals}) {
+                    // после ошибки остальные гости часа уже не продолжатся, но их кадры надо освободить
+                    wakeups->Consume(hour, [this](std::coroutine_handle<> guest) {
+                        if (Error) {
+                            guest.destroy();
+                        } else {
+                            guest.resume();
+                        }
+                    });
+                }
+                RethrowError();
+            }
+        }
+
+        void HandleBookings(IClock::TTime currentTime) {
+            TRACE_SPAN("Emulator::GenerateBookings");
+            for (const auto& booking : GenerateBookings(currentTime)) {
+                Guest(booking);
+                RethrowError();
+            }
+        }
+
+        // Цена брони не зависит от числа ночей, поэтому уехавший раньше платит
+        // долю цены за ночи до отъезда; ночи до опоздавшего заезда номер был за ним и оплачиваются
+        TCost GetStayBill(const TBooking& booking, unsigned departureDay) {
+            const uint64_t bill = GetBill(booking);
+            const uint64_t bookedNights = uint64_t{booking.DayTo} - booking.DayFrom + 1;
+            const uint64_t usedNights = std::min<uint64_t>(departureDay - booking.DayFrom, bookedNights);
+            return static_cast<TCost>(bill * usedNights / bookedNights);
+        }
+
+        void RethrowError() {
+            if (Error) {
+                std::rethrow_exception(std::exchange(Error, nullptr));
+            }
+        }
+
+        TGuest Guest(TBooking booking) {
+            const auto success = Book(booking);
+            ObserveBook(booking, success);
+            TGuestRandom random(Behaviour.Seed, booking.UserId);
+            if (!success) {
+                co_return;
+            }
+            if (random.Happens(Behaviour.NoShowProbability)) {
+                // в день заезда становится ясно, что гостя не будет, и номер снова продается
+                co_await WaitForArrival(booking.DayFrom);
+                Release(booking, booking.DayFrom);
+                co_return;
+            }
+
+            auto arrivalDay = booking.DayFrom;
+            if (random.Happens(Behaviour.LateArrivalProbability)) {
+                ++arrivalDay;
+            }
+            co_await WaitForArrival(arrivalDay);
+            const auto checkedIn = CheckInto(booking);
+            ObserveCheckin(booking, checkedIn);
+            if (!checkedIn) {
+                co_return;
+            }
+
+            while (true) {
+                auto departureDay = booking.DayTo + 1;
+                const auto leavesEarly = arrivalDay < booking.DayTo && random.Happens(Behaviour.EarlyDepartureProbability);
+                if (leavesEarly) {
+                    departureDay = random.Uniform(arrivalDay + 1, booking.DayTo);
+                }
+                co_await WaitForDeparture(departureDay);
+                if (leavesEarly) {
+                    Release(booking, departureDay);
+                }
+                ObserveCheckout(booking, GetStayBill(booking, departureDay));
+                if (leavesEarly || !random.Happens(Behaviour.ExtensionProbability)) {
+                    co_return;
+                }
+
+                // продление - отдельная бронь на следующую ночь, в которую гость сразу заселяется
+                auto extension = booking;
+                extension.DayFrom = departureDay;
+                extension.DayTo = departureDay;
+                const auto extended = Book(extension);
+                ObserveBook(extension, extended);
+                if (!extended) {
+                    co_return;
+                }
+                const auto movedIn = CheckInto(extension);
+                ObserveCheckin(extension, movedIn);
+                if (!movedIn) {
+                    co_return;
+                }
+                booking = extension;
+                arrivalDay = departureDay;
+            }
+        }
+
+    private:
+        const TGuestBehaviour Behaviour;
+        TFramePool FramePool;
+        TWakeups Departures;
+        TWakeups Arrivals;
+        std::exception_ptr Error;
+        unsigned CurrentDay;
+        // Первый час, события которого еще не обработаны
+        unsigned NextHour;
+        unsigned LastWakeupHour = 0;
+    };
+
+    void* TGuest::promise_type::operator new(size_t size, TCoroutineEmulator& emulator, const TBooking& /*booking*/) {
+        return emulator.AllocateFrame(size);
+    }
+
+    void TGuest::promise_type::unhandled_exception() noexcept {
+        Emulator.SetError(std::current_exception());
+    }
+}
+
+std::unique_ptr<IEmulator> CreateCoroutineEmulator(
+    const IEmulator::TContext& context,
+    std::unique_ptr<IDemandGenerator> demandGenerator,
+    const TGuestBehaviour& guestBehaviour
+) {
+    return std::make_unique<TCoroutineEmulator>(context, std::move(demandGenerator), guestBehaviour);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "emulator.h"
+#include <memory>
+
+// Эмулятор, в котором каждый гость - корутина. Создается через IEmulator::Create.
+std::unique_ptr<IEmulator> CreateCoroutineEmulator(
+    const IEmulator::TContext& context,
+    std::unique_ptr<IDemandGenerator> demandGenerator,
+    const TGuestBehaviour& guestBehaviour
+);
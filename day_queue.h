@@ -0,0 +1,142 @@
+#pragma once
+
+#include "memory_accounting.h"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Очередь событий, разложенных по дням.
+// Элементы дня лежат в цепочке блоков фиксированного размера, которые выделяются бамп-аллокацией
+// из общего пула. Когда день обработан, все его блоки целиком возвращаются в пул,
+// так что в установившемся режиме очередь вообще не обращается к куче.
+// Вся память очереди засчитывается компоненту Component.
+template <typename T, size_t BlockSize = 64, EMemoryComponent Component = EMemoryComponent::EmulatorQueues>
+class TDayQueue {
+private:
+    struct TBlock {
+        std::array<T, BlockSize> Items;
+        size_t Size = 0;
+        TBlock* Next = nullptr;
+    };
+
+    struct TDay {
+        TBlock* Head = nullptr;
+        TBlock* Tail = nullptr;
+    };
+
+public:
+    TDayQueue()
+        : Days(16)
+    {
+    }
+
+    TDayQueue(const TDayQueue&) = delete;
+    TDayQueue& operator=(const TDayQueue&) = delete;
+
+    ~TDayQueue() {
+        for (size_t i = 0; i < Blocks.size(); ++i) {
+            TMemoryAccounting::OnDeallocate(Component, sizeof(TBlock), BlockSize);
+        }
+    }
+
+    void Push(unsigned day, const T& item) {
+        if (day < FirstDay) {
+            throw std::runtime_error("Can't add event to the day " + std::to_string(day) + " which has already passed");
+        }
+        while (day - FirstDay >= Days.size()) {
+            Grow();
+        }
+        auto& dayList = GetDay(day);
+        if (!dayList.Tail || dayList.Tail->Size == BlockSize) {
+            auto* block = AllocateBlock();
+            if (dayList.Tail) {
+                dayList.Tail->Next = block;
+            } else {
+                dayList.Head = block;
+            }
+            dayList.Tail = block;
+        }
+        dayList.Tail->Items[dayList.Tail->Size++] = item;
+    }
+
+    // Передает в func все события дня day в порядке добавления и освобождает этот и все предыдущие дни.
+    // Повторный вызов для того же дня ничего не делает.
+    template <typename TFunc>
+    void Consume(unsigned day, TFunc&& func) {
+        if (day < FirstDay) {
+            return;
+        }
+        for (unsigned passedDay = FirstDay; passedDay < day && passedDay - FirstDay < Days.size(); ++passedDay) {
+            ReleaseBlocks(GetDay(passedDay));
+        }
+        TDay dayList;
+        if (day - FirstDay < Days.size()) {
+            std::swap(dayList, GetDay(day));
+        }
+        FirstDay = day + 1;
+        try {
+            for (const auto* block = dayList.Head; block; block = block->Next) {
+                for (size_t i = 0; i < block->Size; ++i) {
+                    func(block->Items[i]);
+                }
+            }
+        } catch (...) {
+            ReleaseBlocks(dayList);
+            throw;
+        }
+        ReleaseBlocks(dayList);
+    }
+
+    size_t GetAllocatedBlocks() const {
+        return Blocks.size();
+    }
+
+private:
+    TDay& GetDay(unsigned day) {
+        return Days[day % Days.size()];
+    }
+
+    // Увеличивает горизонт вдвое, сохраняя ожидающие события
+    void Grow() {
+        TTrackedVector<TDay, Component> days(Days.size() * 2);
+        for (unsigned day = FirstDay; day - FirstDay < Days.size(); ++day) {
+            days[day % days.size()] = GetDay(day);
+        }
+        Days.swap(days);
+    }
+
+    TBlock* AllocateBlock() {
+        if (!FreeBlocks) {
+            TMemoryAccounting::OnAllocate(Component, sizeof(TBlock), BlockSize);
+            try {
+                Blocks.push_back(std::make_unique<TBlock>());
+            } catch (...) {
+                TMemoryAccounting::OnDeallocate(Component, sizeof(TBlock), BlockSize);
+                throw;
+            }
+            return Blocks.back().get();
+        }
+        auto* block = FreeBlocks;
+        FreeBlocks = block->Next;
+        block->Next = nullptr;
+        block->Size = 0;
+        return block;
+    }
+
+    void ReleaseBlocks(TDay& dayList) {
+        if (dayList.Tail) {
+            dayList.Tail->Next = FreeBlocks;
+            FreeBlocks = dayList.Head;
+        }
+        dayList = {};
+    }
+
+private:
+    TTrackedVector<TDay, Component> Days;
+    unsigned FirstDay = 0;
+    TTrackedVector<std::unique_ptr<TBlock>, Component> Blocks;
+    TBlock* FreeBlocks = nullptr;
+};
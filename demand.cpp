@@ -0,0 +1,250 @@
+#include "demand.h"
+#include "alias_table.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+    constexpr unsigned HOURS_IN_DAY = 24;
+    constexpr unsigned DAYS_IN_WEEK = 7;
+    constexpr std::array<unsigned, 12> DAYS_IN_MONTH = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    using TRoomTypeGenerationWeights = TRoomTypeMap<unsigned>;
+
+    std::discrete_distribution<size_t> GetDistribution(const TRoomTypeGenerationWeights& weights) {
+        const auto allWeights = [&]() {
+            std::vector<int> result;
+            result.resize(ROOM_TYPES.size());
+            for (size_t i = 0; i < ROOM_TYPES.size(); ++i) {
+                result[i] = weights[ROOM_TYPES[i]];
+            }
+            return result;
+        }();
+
+        return std::discrete_distribution<size_t>(allWeights.begin(), allWeights.end());
+    }
+
+    class TRoomTypeDistribution {
+    public:
+        TRoomTypeDistribution(const TRoomTypeGenerationWeights& weights)
+            : Distribution(GetDistribution(weights))
+        {
+        }
+
+        template <typename TGenerator>
+        ERoomType operator()(TGenerator& generator) {
+            const auto pos = Distribution(generator);
+            return ROOM_TYPES[pos];
+        }
+
+    private:
+        std::discrete_distribution<size_t> Distribution;
+    };
+
+    constexpr TRoomTypeGenerationWeights ROOM_TYPE_GENERATION_WEIGHTS = {
+        {ERoomType::Single, 10},
+        {ERoomType::Double, 7},
+        {ERoomType::DoubleWithSofa, 5},
+        {ERoomType::HalfLux, 2},
+        {ERoomType::Lux, 1}
+    };
+
+    IClock::TTime SumTime(IClock::TTime l, IClock::TTime r) {
+        return {l.Day + r.Day + (l.Hour + r.Hour) / HOURS_IN_DAY, (l.Hour + r.Hour) % HOURS_IN_DAY};
+    }
+
+    class TUniformDemandGenerator : public IDemandGenerator {
+    public:
+        explicit TUniformDemandGenerator(IClock::TTime startTime)
+            : RandomGenerator(std::random_device()())
+        {
+            SetNextBookingTime(startTime);
+        }
+
+        void Generate(IClock::TTime currentTime, std::vector<TDemand>& demands) override {
+            if (IsTimeToBook(currentTime)) {
+                TDemand demand;
+                demand.DaysUntilBooking = DaysUntilBookingDistribution(RandomGenerator);
+                demand.Duration = BookingDurationDistribution(RandomGenerator);
+                demand.RoomType = RoomTypeDistribution(RandomGenerator);
+                demands.push_back(demand);
+                SetNextBookingTime(currentTime);
+            }
+        }
+
+    private:
+        void SetNextBookingTime(IClock::TTime currentTime) {
+            const auto durationUntilNextBooking = DistributionOfIntervalBetweenBookings(RandomGenerator);
+            NextBookingTime = SumTime(currentTime, IClock::TTime{0, durationUntilNextBooking});
+        }
+
+        bool IsTimeToBook(IClock::TTime currentTime) const {
+            auto timeAsTuple = [](IClock::TTime t) { return std::make_tuple(t.Day, t.Hour); };
+            return timeAsTuple(currentTime) > timeAsTuple(NextBookingTime);
+        }
+
+    private:
+        std::mt19937 RandomGenerator;
+        IClock::TTime NextBookingTime;
+        std::uniform_int_distribution<unsigned> DistributionOfIntervalBetweenBookings{1, 5};
+        std::uniform_int_distribution<unsigned> DaysUntilBookingDistribution{1, 10};
+        std::uniform_int_distribution<unsigned> BookingDurationDistribution{1, 10};
+        TRoomTypeDistribution RoomTypeDistribution{ROOM_TYPE_GENERATION_WEIGHTS};
+    };
+
+    // Счетчиковый генератор Philox4x32-10: значение зависит только от ключа и номера,
+    // поэтому блоки можно заполнять независимо и воспроизводимо
+    class TPhilox {
+    public:
+        using TCounter = std::array<uint32_t, 4>;
+
+    public:
+        explicit TPhilox(uint64_t seed)
+            : Key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        {
+        }
+
+        TCounter operator()(TCounter counter) const {
+            auto key = Key;
+            for (int round = 0; round < 10; ++round) {
+                const uint64_t product0 = uint64_t{0xD2511F53} * counter[0];
+                const uint64_t product1 = uint64_t{0xCD9E8D57} * counter[2];
+                counter = {
+                    static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                    static_cast<uint32_t>(product1),
+                    static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                    static_cast<uint32_t>(product0)
+                };
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            return counter;
+        }
+
+    private:
+        std::array<uint32_t, 2> Key;
+    };
+
+    // Равномерное число из (0, 1)
+    double ToUnit(uint32_t value) {
+        return (value + 0.5) * (1.0 / 4294967296.0);
+    }
+
+    std::vector<double> ToVector(const TRoomTypeMap<double>& weights) {
+        return {weights.begin(), weights.end()};
+    }
+
+    // Кандидаты в заявки генерируются пуассоновским потоком максимальной интенсивности
+    // и прореживаются до интенсивности текущего дня.
+    // Все случайные величины кандидатов заранее считаются блоками по BLOCK_SIZE штук.
+    class TSeasonalDemandGenerator : public IDemandGenerator {
+    public:
+        TSeasonalDemandGenerator(const TSeasonalDemandConfig& config, IClock::TTime startTime)
+            : Config(config)
+            , Philox(config.Seed)
+            , LeadTimes(config.LeadTimeWeights)
+            , Durations(config.DurationWeights)
+            , GroupSizes(config.GroupSizeWeights)
+            , RoomTypes(ToVector(config.RoomTypeWeights))
+        {
+            const auto maxMonth = *std::max_element(Config.MonthFactors.begin(), Config.MonthFactors.end());
+            const auto maxWeekday = *std::max_element(Config.WeekdayFactors.begin(), Config.WeekdayFactors.end());
+            MaxRatePerHour = Config.BookingsPerDay * maxMonth * maxWeekday / HOURS_IN_DAY;
+            if (!(MaxRatePerHour > 0)) {
+                throw std::runtime_error("Booking rate must be positive");
+            }
+            for (unsigned month = 0, day = 0; month < DAYS_IN_MONTH.size(); ++month) {
+                for (unsigned i = 0; i < DAYS_IN_MONTH[month]; ++i, ++day) {
+                    MonthOfDay[day] = month;
+                }
+            }
+            NextArrival = ToHours(startTime);
+            FillBlock();
+            NextArrival += Block.Gaps[0];
+        }
+
+        void Generate(IClock::TTime currentTime, std::vector<TDemand>& demands) override {
+            const auto now = ToHours(currentTime);
+            while (NextArrival <= now) {
+                const auto day = static_cast<unsigned>(NextArrival / HOURS_IN_DAY);
+                if (Block.Accepts[Position] * MaxRatePerHour < GetRatePerHour(day)) {
+                    const TDemand demand{
+                        Block.LeadTimes[Position] + 1,
+                        Block.Durations[Position] + 1,
+                        ROOM_TYPES[Block.RoomTypes[Position]]
+                    };
+                    demands.insert(demands.end(), Block.GroupSizes[Position] + 1, demand);
+                }
+                if (++Position == BLOCK_SIZE) {
+                    FillBlock();
+                }
+                NextArrival += Block.Gaps[Position];
+            }
+        }
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 1024;
+
+        struct TBlock {
+            std::array<double, BLOCK_SIZE> Gaps;
+            std::array<double, BLOCK_SIZE> Accepts;
+            std::array<uint32_t, BLOCK_SIZE> LeadTimes;
+            std::array<uint32_t, BLOCK_SIZE> Durations;
+            std::array<uint32_t, BLOCK_SIZE> GroupSizes;
+            std::array<uint32_t, BLOCK_SIZE> RoomTypes;
+        };
+
+    private:
+        static double ToHours(IClock::TTime time) {
+            return static_cast<double>(time.Day) * HOURS_IN_DAY + time.Hour;
+        }
+
+        double GetRatePerHour(unsigned day) const {
+            const auto month = MonthOfDay[day % MonthOfDay.size()];
+            return Config.BookingsPerDay * Config.MonthFactors[month] * Config.WeekdayFactors[day % DAYS_IN_WEEK] / HOURS_IN_DAY;
+        }
+
+        void FillBlock() {
+            for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                const auto counter = BlockIndex * BLOCK_SIZE + i;
+                const auto low = static_cast<uint32_t>(counter);
+                const auto high = static_cast<uint32_t>(counter >> 32);
+                const auto first = Philox({low, high, 0, 0});
+                const auto second = Philox({low, high, 1, 0});
+                Block.Gaps[i] = -std::log(ToUnit(first[0])) / MaxRatePerHour;
+                Block.Accepts[i] = ToUnit(first[1]);
+                Block.LeadTimes[i] = LeadTimes.Sample(ToUnit(first[2]));
+                Block.Durations[i] = Durations.Sample(ToUnit(first[3]));
+                Block.GroupSizes[i] = GroupSizes.Sample(ToUnit(second[0]));
+                Block.RoomTypes[i] = RoomTypes.Sample(ToUnit(second[1]));
+            }
+            ++BlockIndex;
+            Position = 0;
+        }
+
+    private:
+        const TSeasonalDemandConfig Config;
+        const TPhilox Philox;
+        const TAliasTable LeadTimes;
+        const TAliasTable Durations;
+        const TAliasTable GroupSizes;
+        const TAliasTable RoomTypes;
+        std::array<unsigned, 365> MonthOfDay;
+        double MaxRatePerHour = 0;
+
+        TBlock Block;
+        uint64_t BlockIndex = 0;
+        size_t Position = 0;
+        double NextArrival = 0;
+    };
+}
+
+std::unique_ptr<IDemandGenerator> IDemandGenerator::CreateUniform(IClock::TTime startTime) {
+    return std::make_unique<TUniformDemandGenerator>(startTime);
+}
+
+std::unique_ptr<IDemandGenerator> IDemandGenerator::CreateSeasonal(const TSeasonalDemandConfig& config, IClock::TTime startTime) {
+    return std::make_unique<TSeasonalDemandGenerator>(config, startTime);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "booking_system.h"
+#include "clock.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Запрос гостя на бронирование, еще не привязанный к гостю и к дате
+struct TDemand {
+    // Через сколько дней после запроса гость заедет
+    unsigned DaysUntilBooking;
+    // Сколько дней гость проживет
+    unsigned Duration;
+    ERoomType RoomType;
+};
+
+// Параметры сезонного спроса. Интенсивность заявок в день day равна
+// BookingsPerDay * MonthFactors[месяц day] * WeekdayFactors[day % 7], день 0 - понедельник 1 января.
+struct TSeasonalDemandConfig {
+    double BookingsPerDay = 8;
+    std::array<double, 12> MonthFactors = {0.6, 0.6, 0.8, 0.9, 1.0, 1.3, 1.6, 1.6, 1.1, 0.9, 0.7, 1.0};
+    std::array<double, 7> WeekdayFactors = {0.9, 0.9, 0.9, 1.0, 1.2, 1.1, 1.0};
+    // Веса i-го элемента относятся к значению i + 1
+    std::vector<double> LeadTimeWeights = std::vector<double>(10, 1);
+    std::vector<double> DurationWeights = std::vector<double>(10, 1);
+    std::vector<double> GroupSizeWeights = {0.85, 0.1, 0.05};
+    TRoomTypeMap<double> RoomTypeWeights = {
+        {ERoomType::Single, 10},
+        {ERoomType::Double, 7},
+        {ERoomType::DoubleWithSofa, 5},
+        {ERoomType::HalfLux, 2},
+        {ERoomType::Lux, 1}
+    };
+    // Одинаковое зерно дает одинаковый поток заявок
+    uint64_t Seed = 0;
+};
+
+// Источник заявок на бронирование для эмулятора
+class IDemandGenerator {
+public:
+    virtual ~IDemandGenerator() = default;
+
+    // Дописывает в demands заявки, пришедшие после прошлого вызова и не позже currentTime
+    virtual void Generate(IClock::TTime currentTime, std::vector<TDemand>& demands) = 0;
+
+public:
+    // Не чаще одной заявки за шаг, интервалы, сроки и типы номеров распределены равномерно
+    static std::unique_ptr<IDemandGenerator> CreateUniform(IClock::TTime startTime);
+    // Неоднородный пуассоновский поток с сезонностью и групповыми заявками.
+    // Случайные величины готовятся блоками из счетчикового генератора Philox.
+    static std::unique_ptr<IDemandGenerator> CreateSeasonal(const TSeasonalDemandConfig& config, IClock::TTime startTime);
+};
@@ -0,0 +1,117 @@
+#include "alias_table.h"
+#include "demand.h"
+#include "unit_test.h"
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+    std::vector<double> GetFrequencies(const std::vector<unsigned>& counts) {
+        const auto total = std::accumulate(counts.begin(), counts.end(), 0.0);
+        std::vector<double> result;
+        for (const auto count : counts) {
+            result.push_back(count / total);
+        }
+        return result;
+    }
+
+    std::vector<double> Normalize(const std::vector<double>& weights) {
+        const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+        std::vector<double> result;
+        for (const auto weight : weights) {
+            result.push_back(weight / total);
+        }
+        return result;
+    }
+}
+
+// На равномерной сетке чисел доля каждого значения совпадает с его весом
+// с точностью до границ столбцов таблицы
+TEST(AliasTableMatchesWeights) {
+    const std::vector<std::vector<double>> allWeights = {
+        {1},
+        {1, 1, 1, 1},
+        {10, 7, 5, 2, 1},
+        {0.85, 0.1, 0.05},
+        {3, 0, 1, 6, 0},
+        {1e-3, 1, 1e3}
+    };
+    constexpr unsigned POINTS = 1000000;
+    for (const auto& weights : allWeights) {
+        const TAliasTable table(weights);
+        std::vector<unsigned> counts(weights.size());
+        for (unsigned i = 0; i < POINTS; ++i) {
+            const auto value = table.Sample((i + 0.5) / POINTS);
+            CHECK(value < weights.size());
+            ++counts[value];
+        }
+        const auto expected = Normalize(weights);
+        const auto frequencies = GetFrequencies(counts);
+        for (size_t i = 0; i < weights.size(); ++i) {
+            CHECK(std::abs(frequencies[i] - expected[i]) <= 2.0 * weights.size() / POINTS);
+            if (weights[i] == 0) {
+                CHECK(counts[i] == 0);
+            }
+        }
+    }
+}
+
+TEST(AliasTableRejectsBadWeights) {
+    for (const auto& weights : std::vector<std::vector<double>>{{}, {0, 0}, {1, -1, 2}}) {
+        bool thrown = false;
+        try {
+            TAliasTable table(weights);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
+
+// Сроки и типы номеров заявок сезонного генератора распределены по весам конфига
+// (в пределах пяти стандартных отклонений), а одно зерно дает один и тот же поток
+TEST(SeasonalDemandFollowsWeights) {
+    TSeasonalDemandConfig config;
+    config.BookingsPerDay = 200;
+    config.GroupSizeWeights = {1};
+    config.DurationWeights = {1, 2, 3, 4, 0, 10};
+    config.Seed = 5;
+
+    std::vector<TDemand> demands;
+    const auto generator = IDemandGenerator::CreateSeasonal(config, {0, 0});
+    for (unsigned day = 0; day < 365; ++day) {
+        generator->Generate({day, 23}, demands);
+    }
+    CHECK(demands.size() > 10000);
+
+    std::vector<unsigned> durations(config.DurationWeights.size());
+    std::vector<unsigned> roomTypes(ROOM_TYPES.size());
+    for (const auto& demand : demands) {
+        CHECK(demand.Duration >= 1 && demand.Duration <= durations.size());
+        ++durations[demand.Duration - 1];
+        ++roomTypes[static_cast<size_t>(demand.RoomType)];
+    }
+    auto checkFrequencies = [&demands](const std::vector<unsigned>& counts, const std::vector<double>& weights) {
+        const auto expected = Normalize(weights);
+        const auto frequencies = GetFrequencies(counts);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const auto sigma = std::sqrt(expected[i] * (1 - expected[i]) / demands.size());
+            CHECK(std::abs(frequencies[i] - expected[i]) <= 5 * sigma);
+        }
+    };
+    checkFrequencies(durations, config.DurationWeights);
+    checkFrequencies(roomTypes, {config.RoomTypeWeights.begin(), config.RoomTypeWeights.end()});
+
+    std::vector<TDemand> repeated;
+    const auto sameGenerator = IDemandGenerator::CreateSeasonal(config, {0, 0});
+    for (unsigned day = 0; day < 365; ++day) {
+        sameGenerator->Generate({day, 23}, repeated);
+    }
+    CHECK(repeated.size() == demands.size());
+    for (size_t i = 0; i < demands.size() && i < repeated.size(); ++i) {
+        CHECK(repeated[i].DaysUntilBooking == demands[i].DaysUntilBooking);
+        CHECK(repeated[i].Duration == demands[i].Duration);
+        CHECK(repeated[i].RoomType == demands[i].RoomType);
+    }
+}
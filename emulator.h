@@ -2,6 +2,9 @@
 
 #include "booking_system.h"
 #include "clock.h"
+#include "demand.h"
+#include <cstdint>
+#include <memory>
 
 class IEmulatorObserver {
 public:
@@ -10,6 +13,24 @@ public:
     virtual void OnBook(const TBooking& booking, bool success) = 0;
     virtual void OnCheckin(const TBooking& booking, bool success) = 0;
     virtual void OnCheckout(const TBooking& booking, TCost cost) = 0;
+    // Вызывается один раз для каждого завершившегося дня, до событий следующего дня
+    virtual void OnDayEnd(unsigned day) = 0;
+};
+
+// Отклонения гостей от забронированных дат. Учитываются только эмулятором типа Coroutine,
+// при нулевых вероятностях он выдает наблюдателям те же события в том же порядке, что и Simple.
+struct TGuestBehaviour {
+    // Гость не приезжает вовсе; в день заезда бронь снимается, и номер освобождается на все ее дни
+    double NoShowProbability = 0;
+    // Гость приезжает на день позже; если бронь была на одну ночь, заселиться он уже не сможет.
+    // Номер в пропущенную ночь остается за ним и оплачивается.
+    double LateArrivalProbability = 0;
+    // Гость уезжает раньше, в случайный день до конца брони. Оставшиеся ночи освобождаются,
+    // а платит он долю цены брони за ночи до отъезда.
+    double EarlyDepartureProbability = 0;
+    // В день выезда гость пытается продлить проживание еще на одну ночь, и так каждый раз
+    double ExtensionProbability = 0;
+    uint64_t Seed = 0;
 };
 
 // Отвечает за стратегию создания заказов
@@ -21,6 +42,13 @@ public:
         const IClock& Clock;
     };
 
+    // Simple - заезды и выезды разложены по очередям дней,
+    // Coroutine - каждый гость это корутина, которая ждет нужного момента эмуляции
+    enum class EType {
+        Simple,
+        Coroutine
+    };
+
 public:
     virtual ~IEmulator() = default;
 
@@ -28,5 +56,11 @@ public:
     virtual void MakeStep() = 0;
 
 public:
-    static std::unique_ptr<IEmulator> Create(const TContext& context);
+    // Без demandGenerator заявки создаются равномерным генератором
+    static std::unique_ptr<IEmulator> Create(
+        const TContext& context,
+        std::unique_ptr<IDemandGenerator> demandGenerator = nullptr,
+        EType type = EType::Simple,
+        const TGuestBehaviour& guestBehaviour = {}
+    );
 };
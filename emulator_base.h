@@ -0,0 +1,98 @@
+#pragma once
+
+#include "emulator.h"
+#include "trace.h"
+#include <vector>
+
+// Общая часть эмуляторов: обращения к системе бронирования и рассылка событий наблюдателям
+class TEmulatorBase : public IEmulator {
+public:
+    TEmulatorBase(const TContext& context, std::unique_ptr<IDemandGenerator> demandGenerator)
+        : Context(context)
+        , DemandGenerator(std::move(demandGenerator))
+    {
+    }
+
+    void AddObserver(IEmulatorObserver& observer) override {
+        Observers.push_back(&observer);
+    }
+
+protected:
+    // Заявки текущего шага, уже превращенные в бронирования новых гостей
+    const std::vector<TBooking>& GenerateBookings(IClock::TTime currentTime) {
+        Demands.clear();
+        {
+            TRACE_SPAN("DemandGenerator::Generate");
+            DemandGenerator->Generate(currentTime, Demands);
+        }
+        NewBookings.clear();
+        for (const auto& demand : Demands) {
+            TBooking booking;
+            booking.UserId = UserId;
+            ++UserId;
+            booking.DayFrom = currentTime.Day + demand.DaysUntilBooking;
+            booking.DayTo = booking.DayFrom + demand.Duration - 1;
+            booking.RoomType = demand.RoomType;
+            NewBookings.push_back(booking);
+        }
+        return NewBookings;
+    }
+
+    bool Book(const TBooking& booking) {
+        TRACE_SPAN("BookingSystem::Book");
+        return Context.BookingSystem.Book(booking);
+    }
+
+    bool CheckInto(const TBooking& booking) {
+        TRACE_SPAN("BookingSystem::CheckInto");
+        return Context.BookingSystem.CheckInto(booking);
+    }
+
+    TCost GetBill(const TBooking& booking) {
+        TRACE_SPAN("BookingSystem::GetBill");
+        return Context.BookingSystem.GetBill(booking);
+    }
+
+    bool Release(const TBooking& booking, unsigned dayFrom) {
+        TRACE_SPAN("BookingSystem::Release");
+        return Context.BookingSystem.Release(booking, dayFrom);
+    }
+
+    void ObserveBook(const TBooking& booking, bool success) {
+        TRACE_SPAN("Emulator::ObserveBook");
+        for (auto* observer : Observers) {
+            observer->OnBook(booking, success);
+        }
+    }
+
+    void ObserveCheckin(const TBooking& booking, bool success) {
+        TRACE_SPAN("Emulator::ObserveCheckin");
+        for (auto* observer : Observers) {
+            observer->OnCheckin(booking, success);
+        }
+    }
+
+    void ObserveCheckout(const TBooking& booking, TCost cost) {
+        TRACE_SPAN("Emulator::ObserveCheckout");
+        for (auto* observer : Observers) {
+            observer->OnCheckout(booking, cost);
+        }
+    }
+
+    void ObserveDayEnd(unsigned day) {
+        TRACE_SPAN("Emulator::ObserveDayEnd");
+        for (auto* observer : Observers) {
+            observer->OnDayEnd(day);
+        }
+    }
+
+protected:
+    const TContext Context;
+
+private:
+    std::unique_ptr<IDemandGenerator> DemandGenerator;
+    std::vector<IEmulatorObserver*> Observers;
+    std::vector<TDemand> Demands;
+    std::vector<TBooking> NewBookings;
+    TUserId UserId = 0;
+};
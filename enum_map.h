@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+// Отображение из плотного перечисления (значения 0..Size-1) в значения на основе std::array.
+// Заменяет std::unordered_map там, где ключ - тип номера: без хеширования и выделений памяти.
+// Все ключи всегда присутствуют, отсутствующие в инициализаторе получают значение по умолчанию.
+template <typename TEnum, size_t Size, typename TValue>
+class TEnumMap {
+public:
+    using value_type = TValue;
+    using iterator = typename std::array<TValue, Size>::iterator;
+    using const_iterator = typename std::array<TValue, Size>::const_iterator;
+
+public:
+    constexpr TEnumMap() = default;
+
+    constexpr TEnumMap(std::initializer_list<std::pair<TEnum, TValue>> items) {
+        for (const auto& item : items) {
+            at(item.first) = item.second;
+        }
+    }
+
+    constexpr TValue& operator[](TEnum key) {
+        return Values[static_cast<size_t>(key)];
+    }
+
+    constexpr const TValue& operator[](TEnum key) const {
+        return Values[static_cast<size_t>(key)];
+    }
+
+    constexpr TValue& at(TEnum key) {
+        CheckKey(key);
+        return Values[static_cast<size_t>(key)];
+    }
+
+    constexpr const TValue& at(TEnum key) const {
+        CheckKey(key);
+        return Values[static_cast<size_t>(key)];
+    }
+
+    static constexpr size_t size() {
+        return Size;
+    }
+
+    constexpr void fill(const TValue& value) {
+        for (auto& item : Values) {
+            item = value;
+        }
+    }
+
+    // Итерация идет по значениям в порядке ключей
+    constexpr iterator begin() {
+        return Values.begin();
+    }
+
+    constexpr iterator end() {
+        return Values.end();
+    }
+
+    constexpr const_iterator begin() const {
+        return Values.begin();
+    }
+
+    constexpr const_iterator end() const {
+        return Values.end();
+    }
+
+private:
+    static constexpr void CheckKey(TEnum key) {
+        if (static_cast<size_t>(key) >= Size) {
+            throw std::out_of_range("Invalid enum key");
+        }
+    }
+
+private:
+    std::array<TValue, Size> Values{};
+};
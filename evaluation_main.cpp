@@ -0,0 +1,120 @@
+#include "memory_report.h"
+#include "paired_evaluation.h"
+#include "trace.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--days N] [--replicas N] [--step HOURS] [--rate BOOKINGS_PER_DAY] [--seed N] [--bitset] [--trace FILE]"
+                  << " [--coroutines] [--no-show P] [--late-arrival P] [--early-departure P] [--extension P]"
+                  << " [--memory] [--memory-csv FILE] [--memory-budget COMPONENT=BYTES]\n"
+                  << "  --bitset  keep occupancy in bit layers instead of hash sets; decisions are the same\n"
+                  << "  --memory  print live memory per component at the end of the last day of the first replica\n"
+                  << "  --memory-csv FILE  write live memory per component for every day of the first replica\n";
+    }
+
+    // COMPONENT=BYTES, например HotelPlan=1000000
+    void SetMemoryBudget(const std::string& value) {
+        const auto separator = value.find('=');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Memory budget must look like COMPONENT=BYTES, got " + value);
+        }
+        const auto component = MemoryComponentFromString(value.substr(0, separator));
+        TMemoryAccounting::SetBudget(component, std::stoull(value.substr(separator + 1)));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TPairedEvaluationConfig config;
+    // те же значения, что по умолчанию в окне эмуляции
+    config.RoomCounts = {
+        {ERoomType::Single, 12},
+        {ERoomType::Double, 8},
+        {ERoomType::DoubleWithSofa, 4},
+        {ERoomType::HalfLux, 2},
+        {ERoomType::Lux, 1}
+    };
+    config.RoomCosts = {
+        {ERoomType::Single, 3000},
+        {ERoomType::Double, 4500},
+        {ERoomType::DoubleWithSofa, 5000},
+        {ERoomType::HalfLux, 8000},
+        {ERoomType::Lux, 10000}
+    };
+
+    std::string tracePath;
+    bool printMemory = false;
+    std::string memoryCsvPath;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const auto hasValue = i + 1 < argc;
+            if (!std::strcmp(argv[i], "--days") && hasValue) {
+                config.Days = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--replicas") && hasValue) {
+                config.Replicas = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--step") && hasValue) {
+                config.StepHours = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--rate") && hasValue) {
+                config.Demand.BookingsPerDay = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+                config.Demand.Seed = std::stoull(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--bitset")) {
+                config.PlanType = IBookingSystem::EPlanType::Bitset;
+            } else if (!std::strcmp(argv[i], "--trace") && hasValue) {
+                tracePath = argv[++i];
+            } else if (!std::strcmp(argv[i], "--coroutines")) {
+                config.EmulatorType = IEmulator::EType::Coroutine;
+            } else if (!std::strcmp(argv[i], "--no-show") && hasValue) {
+                config.GuestBehaviour.NoShowProbability = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--late-arrival") && hasValue) {
+                config.GuestBehaviour.LateArrivalProbability = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--early-departure") && hasValue) {
+                config.GuestBehaviour.EarlyDepartureProbability = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--extension") && hasValue) {
+                config.GuestBehaviour.ExtensionProbability = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--memory")) {
+                printMemory = true;
+            } else if (!std::strcmp(argv[i], "--memory-csv") && hasValue) {
+                memoryCsvPath = argv[++i];
+            } else if (!std::strcmp(argv[i], "--memory-budget") && hasValue) {
+                SetMemoryBudget(argv[++i]);
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        std::optional<TTraceFile> traceFile;
+        if (!tracePath.empty()) {
+            traceFile.emplace(tracePath);
+        }
+        // После EvaluatePaired все системы уже разрушены и живых байтов нет,
+        // поэтому отчет снимается на конец каждого дня первого прогона
+        TMemoryReporter memoryReporter;
+        if (printMemory || !memoryCsvPath.empty()) {
+            config.FirstReplicaObserver = &memoryReporter;
+        }
+        PrintReport(EvaluatePaired(config), std::cout);
+        const auto& memoryHistory = memoryReporter.GetHistory();
+        if (printMemory && !memoryHistory.empty()) {
+            std::cout << "Memory at the end of day " << memoryHistory.back().Day << " of the first replica\n";
+            PrintMemoryReport(memoryHistory.back().Report, std::cout);
+        }
+        if (!memoryCsvPath.empty()) {
+            std::ofstream memoryCsv(memoryCsvPath);
+            if (!memoryCsv) {
+                throw std::runtime_error("Can't open " + memoryCsvPath);
+            }
+            memoryReporter.WriteCsv(memoryCsv);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
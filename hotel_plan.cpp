@@ -0,0 +1,320 @@
+#include "hotel_plan.h"
+#include "availability.h"
+#include "memory_accounting.h"
+#include "occupancy_kernels.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr auto PLAN_MEMORY = EMemoryComponent::HotelPlan;
+
+    [[noreturn]] void ThrowAllRoomsBusy(ERoomType roomType, unsigned day) {
+        throw std::runtime_error(
+            "All rooms of type " + std::to_string(static_cast<int>(roomType)) +
+            " are busy at " + std::to_string(day) + " day"
+        );
+    }
+
+    [[noreturn]] void ThrowNoBookingToRelease(TUserId userId, unsigned dayFrom, unsigned dayTo) {
+        throw std::runtime_error(
+            "Guest " + std::to_string(userId) + " has no booking to release at days " +
+            std::to_string(dayFrom) + ".." + std::to_string(dayTo)
+        );
+    }
+
+    // Для каждого типа и дня хранит множество гостей, занявших номер этого типа.
+    // Номер внутри типа не фиксируется: гостю достаточно, чтобы каждый день был свободен хоть один номер.
+    // Дни перебираются 64-битным счетчиком, иначе цикл до dayTo == UINT_MAX не завершится.
+    class THashHotelPlan : public IHotelPlan {
+    public:
+        explicit THashHotelPlan(TRoomCounts roomCounts)
+            : RoomCounts(std::move(roomCounts))
+        {
+        }
+
+        bool Has(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const override {
+            const auto roomCount = RoomCounts.at(roomType);
+            if (roomCount == 0) {
+                return false;
+            }
+            const auto& busyByDay = BusyRooms.at(roomType);
+            for (uint64_t day = dayFrom; day <= dayTo; ++day) {
+                const auto it = busyByDay.find(static_cast<unsigned>(day));
+                if (it != busyByDay.end() && it->second.size() == roomCount) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Бронь записывается целиком или никак: если выделение памяти не удалось
+        // (например, кончился бюджет памяти плана), уже добавленные дни откатываются
+        void Book(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) override {
+            if (!Has(roomType, dayFrom, dayTo)) {
+                ThrowAllRoomsBusy(roomType, dayFrom);
+            }
+            if (dayTo < dayFrom) {
+                return;
+            }
+            MarkChanging(dayFrom, dayTo);
+            NewDays.clear();
+            NewDays.reserve(size_t{dayTo} - dayFrom + 1);
+            auto& busyByDay = BusyRooms.at(roomType);
+            try {
+                for (uint64_t day = dayFrom; day <= dayTo; ++day) {
+                    if (busyByDay[static_cast<unsigned>(day)].insert(userId).second) {
+                        NewDays.push_back(static_cast<unsigned>(day));
+                    }
+                }
+            } catch (...) {
+                for (const auto day : NewDays) {
+                    busyByDay[day].erase(userId);
+                }
+                throw;
+            }
+            LastDay = std::max(LastDay, dayTo);
+            ++Version;
+        }
+
+        bool HasBooking(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) const override {
+            const auto& busyByDay = BusyRooms.at(roomType);
+            for (uint64_t day = dayFrom; day <= dayTo; ++day) {
+                const auto it = busyByDay.find(static_cast<unsigned>(day));
+                if (it == busyByDay.end() || it->second.count(userId) == 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void Release(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) override {
+            if (dayTo < dayFrom || !HasBooking(userId, roomType, dayFrom, dayTo)) {
+                ThrowNoBookingToRelease(userId, dayFrom, dayTo);
+            }
+            MarkChanging(dayFrom, dayTo);
+            auto& busyByDay = BusyRooms.at(roomType);
+            for (uint64_t day = dayFrom; day <= dayTo; ++day) {
+                const auto it = busyByDay.find(static_cast<unsigned>(day));
+                it->second.erase(userId);
+                if (it->second.empty()) {
+                    busyByDay.erase(it);
+                }
+            }
+            ++Version;
+        }
+
+        unsigned GetBusyRooms(ERoomType roomType, unsigned day) const override {
+            const auto& busyByDay = BusyRooms.at(roomType);
+            const auto it = busyByDay.find(day);
+            return it != busyByDay.end() ? it->second.size() : 0;
+        }
+
+        const TRoomCounts& GetRoomCounts() const override {
+            return RoomCounts;
+        }
+
+        unsigned GetLastDay() const override {
+            return LastDay;
+        }
+
+        uint64_t GetVersion() const override {
+            return Version;
+        }
+
+    private:
+        const TRoomCounts RoomCounts;
+        // room type, date, busy rooms count
+        TRoomTypeMap<TTrackedUnorderedMap<unsigned, TTrackedUnorderedSet<TUserId, PLAN_MEMORY>, PLAN_MEMORY>> BusyRooms;
+        // Дни, в которые Book добавил гостя; хранится между вызовами, чтобы не выделять память каждый раз
+        TTrackedVector<unsigned, PLAN_MEMORY> NewDays;
+        unsigned LastDay = 0;
+        uint64_t Version = 0;
+    };
+
+    // Правила те же, что у THashHotelPlan: номер внутри типа не фиксируется, и гостя можно поселить,
+    // если в каждый день отрезка свободен хоть один номер. Занятость типа хранится битовыми
+    // слоями: бит дня выставлен в слое k, если в этот день занято больше k номеров.
+    // Book выставляет день в нижнем слое, где он свободен, а Release снимает с верхнего, где он занят,
+    // поэтому слои вложены друг в друга, а последний слой отмечает дни, когда заняты все номера:
+    // проверка отрезка сводится к OR слов этого слоя - по 64 дня за слово.
+    // Рассчитан на гостиницы с небольшим числом номеров каждого типа.
+    class TBitsetHotelPlan : public IHotelPlan {
+    public:
+        explicit TBitsetHotelPlan(TRoomCounts roomCounts)
+            : RoomCounts(std::move(roomCounts))
+        {
+            for (const auto roomType : ROOM_TYPES) {
+                Layers[roomType].resize(RoomCounts[roomType]);
+            }
+        }
+
+        bool Has(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const override {
+            const auto& layers = Layers.at(roomType);
+            if (layers.empty()) {
+                return false;
+            }
+            const auto& allBusy = layers.back();
+            return IsRangeFree(allBusy.data(), allBusy.size(), dayFrom, dayTo);
+        }
+
+        void Book(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) override {
+            if (!Has(roomType, dayFrom, dayTo)) {
+                ThrowAllRoomsBusy(roomType, dayFrom);
+            }
+            if (dayTo < dayFrom) {
+                return;
+            }
+            MarkChanging(dayFrom, dayTo);
+            auto& layers = Layers.at(roomType);
+            const size_t wordsCount = dayTo / 64 + 1;
+            for (auto& layer : layers) {
+                if (layer.size() < wordsCount) {
+                    layer.resize(wordsCount, 0);
+                }
+            }
+            // все выделения памяти до изменения слоев, чтобы исключение не оставило полброни
+            Stays.emplace(userId, TStay{roomType, dayFrom, dayTo});
+            for (size_t word = dayFrom / 64; word <= dayTo / 64; ++word) {
+                // день попадает в первый слой, где он еще свободен; Has гарантирует, что такой слой есть
+                auto days = GetRangeMask(word, dayFrom, dayTo);
+                for (auto it = layers.begin(); days != 0; ++it) {
+                    const auto added = days & ~(*it)[word];
+                    (*it)[word] |= added;
+                    days &= ~added;
+                }
+            }
+            LastDay = std::max(LastDay, dayTo);
+            ++Version;
+        }
+
+        bool HasBooking(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) const override {
+            if (dayTo < dayFrom) {
+                return true;
+            }
+            const auto [begin, end] = Stays.equal_range(userId);
+            return std::any_of(begin, end, [&](const auto& item) {
+                const auto& stay = item.second;
+                return stay.RoomType == roomType && stay.DayFrom <= dayFrom && dayTo <= stay.DayTo;
+            });
+        }
+
+        void Release(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) override {
+            const auto [begin, end] = Stays.equal_range(userId);
+            const auto stay = std::find_if(begin, end, [&](const auto& item) {
+                return item.second.RoomType == roomType && item.second.DayFrom <= dayFrom && item.second.DayTo == dayTo;
+            });
+            if (dayTo < dayFrom || stay == end) {
+                ThrowNoBookingToRelease(userId, dayFrom, dayTo);
+            }
+            MarkChanging(dayFrom, dayTo);
+            if (stay->second.DayFrom < dayFrom) {
+                stay->second.DayTo = dayFrom - 1;
+            } else {
+                Stays.erase(stay);
+            }
+            auto& layers = Layers.at(roomType);
+            for (size_t word = dayFrom / 64; word <= dayTo / 64; ++word) {
+                // день уходит из верхнего слоя, где он занят, так что слои остаются вложенными
+                auto days = GetRangeMask(word, dayFrom, dayTo);
+                for (auto it = layers.rbegin(); days != 0; ++it) {
+                    const auto removed = days & (*it)[word];
+                    (*it)[word] &= ~removed;
+                    days &= ~removed;
+                }
+            }
+            ++Version;
+        }
+
+        unsigned GetBusyRooms(ERoomType roomType, unsigned day) const override {
+            const size_t word = day / 64;
+            const uint64_t bit = uint64_t{1} << (day % 64);
+            unsigned result = 0;
+            for (const auto& layer : Layers.at(roomType)) {
+                if (word >= layer.size() || !(layer[word] & bit)) {
+                    break;
+                }
+                ++result;
+            }
+            return result;
+        }
+
+        const TRoomCounts& GetRoomCounts() const override {
+            return RoomCounts;
+        }
+
+        unsigned GetLastDay() const override {
+            return LastDay;
+        }
+
+        uint64_t GetVersion() const override {
+            return Version;
+        }
+
+    private:
+        using TLayer = TTrackedVector<uint64_t, PLAN_MEMORY>;
+
+        struct TStay {
+            ERoomType RoomType;
+            unsigned DayFrom;
+            unsigned DayTo;
+        };
+
+    private:
+        const TRoomCounts RoomCounts;
+        // room type, busy rooms count - 1, days
+        TRoomTypeMap<TTrackedVector<TLayer, PLAN_MEMORY>> Layers;
+        TTrackedUnorderedMultimap<TUserId, TStay, PLAN_MEMORY> Stays;
+        unsigned LastDay = 0;
+        uint64_t Version = 0;
+    };
+}
+
+std::shared_ptr<const TAvailabilitySnapshot> IHotelPlan::MakeAvailabilitySnapshot(
+    unsigned firstDay,
+    const TAvailabilitySnapshot* previous
+) const {
+    constexpr auto DAYS_IN_CHUNK = TAvailabilitySnapshot::DAYS_IN_CHUNK;
+    const auto lastDay = GetLastDay();
+    const size_t firstChunk = firstDay / DAYS_IN_CHUNK;
+    const size_t chunksCount = lastDay >= firstDay ? lastDay / DAYS_IN_CHUNK - firstChunk + 1 : 0;
+    TRoomTypeMap<TAvailabilitySnapshot::TChunks> busyRooms;
+    for (const auto roomType : ROOM_TYPES) {
+        auto& chunks = busyRooms[roomType];
+        chunks.reserve(chunksCount);
+        for (auto chunk = firstChunk; chunk < firstChunk + chunksCount; ++chunk) {
+            const auto* previousChunk = previous ? previous->FindChunk(roomType, chunk) : nullptr;
+            const auto chunkVersion = chunk < ChunkVersions.size() ? ChunkVersions[chunk] : 0;
+            if (previousChunk && chunkVersion <= previous->GetVersion()) {
+                chunks.push_back(*previousChunk);
+                continue;
+            }
+            auto newChunk = TAvailabilitySnapshot::MakeChunk();
+            for (unsigned i = 0; i < DAYS_IN_CHUNK; ++i) {
+                (*newChunk)[i] = GetBusyRooms(roomType, static_cast<unsigned>(chunk * DAYS_IN_CHUNK + i));
+            }
+            chunks.push_back(std::move(newChunk));
+        }
+    }
+    return std::make_shared<const TAvailabilitySnapshot>(GetVersion(), firstDay, GetRoomCounts(), std::move(busyRooms));
+}
+
+void IHotelPlan::MarkChanging(unsigned dayFrom, unsigned dayTo) {
+    const size_t lastChunk = dayTo / TAvailabilitySnapshot::DAYS_IN_CHUNK;
+    if (ChunkVersions.size() <= lastChunk) {
+        ChunkVersions.resize(lastChunk + 1, 0);
+    }
+    for (size_t chunk = dayFrom / TAvailabilitySnapshot::DAYS_IN_CHUNK; chunk <= lastChunk; ++chunk) {
+        ChunkVersions[chunk] = GetVersion() + 1;
+    }
+}
+
+std::unique_ptr<IHotelPlan> IHotelPlan::Create(TRoomCounts roomCounts, IBookingSystem::EPlanType type) {
+    switch (type) {
+        case IBookingSystem::EPlanType::Hash:
+            return std::make_unique<THashHotelPlan>(std::move(roomCounts));
+        case IBookingSystem::EPlanType::Bitset:
+            return std::make_unique<TBitsetHotelPlan>(std::move(roomCounts));
+    }
+    throw std::runtime_error("Unknown hotel plan type");
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "booking_system.h"
+#include "memory_accounting.h"
+#include <cstdint>
+#include <memory>
+
+// План занятости номеров гостиницы по дням
+class IHotelPlan {
+public:
+    virtual ~IHotelPlan() = default;
+
+    // Можно ли поселить гостя в номер данного типа на все дни отрезка [dayFrom, dayTo]
+    virtual bool Has(ERoomType roomType, unsigned dayFrom, unsigned dayTo) const = 0;
+    // Пустой отрезок (dayTo < dayFrom), как и раньше, принимается и ничего не занимает
+    virtual void Book(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) = 0;
+    virtual bool HasBooking(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) const = 0;
+    // Освобождает конец [dayFrom, dayTo] одной из броней гостя: он уехал раньше или не приехал.
+    // Если гость не занимает номер этого типа во все дни отрезка, бросает исключение.
+    virtual void Release(TUserId userId, ERoomType roomType, unsigned dayFrom, unsigned dayTo) = 0;
+
+    virtual unsigned GetBusyRooms(ERoomType roomType, unsigned day) const = 0;
+    virtual const TRoomCounts& GetRoomCounts() const = 0;
+    // Последний день, на который есть бронирования
+    virtual unsigned GetLastDay() const = 0;
+    // Увеличивается при каждом изменении плана
+    virtual uint64_t GetVersion() const = 0;
+
+    // Снимок занятости начиная с дня firstDay. Куски дней, которые не менялись
+    // после версии previous, берутся из него без пересчета.
+    std::shared_ptr<const TAvailabilitySnapshot> MakeAvailabilitySnapshot(unsigned firstDay, const TAvailabilitySnapshot* previous) const;
+
+public:
+    static std::unique_ptr<IHotelPlan> Create(TRoomCounts roomCounts, IBookingSystem::EPlanType type);
+
+protected:
+    // Вызывается из Book до изменения плана: дни [dayFrom, dayTo] меняются в следующей версии.
+    // Если Book затем не удался, соответствующие куски снимка лишь лишний раз пересчитаются.
+    void MarkChanging(unsigned dayFrom, unsigned dayTo);
+
+private:
+    // Версия плана, в которой последний раз менялся каждый кусок дней снимка
+    TTrackedVector<uint64_t, EMemoryComponent::HotelPlan> ChunkVersions;
+};
@@ -0,0 +1,83 @@
+#include "availability.h"
+#include "hotel_plan.h"
+#include "unit_test.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+    struct TStay {
+        TUserId UserId;
+        ERoomType RoomType;
+        unsigned DayFrom;
+        unsigned DayTo;
+    };
+}
+
+// Оба плана получают одни и те же заявки и освобождения и должны одинаково отвечать
+// на все вопросы, включая снимок занятости битового плана
+TEST(HashAndBitsetPlansAgree) {
+    std::mt19937 random(3);
+    for (int plan = 0; plan < 500; ++plan) {
+        TRoomCounts roomCounts;
+        for (const auto roomType : ROOM_TYPES) {
+            roomCounts[roomType] = random() % 4;
+        }
+        const auto hash = IHotelPlan::Create(roomCounts, IBookingSystem::EPlanType::Hash);
+        const auto bitset = IHotelPlan::Create(roomCounts, IBookingSystem::EPlanType::Bitset);
+        std::vector<TStay> stays;
+        for (TUserId userId = 0; userId < 60; ++userId) {
+            const auto roomType = ROOM_TYPES[random() % ROOM_TYPES.size()];
+            unsigned dayFrom = random() % 200;
+            unsigned dayTo = dayFrom + random() % 70;
+            // изредка пустой отрезок, он принимается и ничего не занимает
+            if (random() % 20 == 0) {
+                dayFrom = dayTo + 1 + random() % 5;
+            }
+
+            const auto snapshot = bitset->MakeAvailabilitySnapshot(0, nullptr);
+            const auto has = hash->Has(roomType, dayFrom, dayTo);
+            CHECK(bitset->Has(roomType, dayFrom, dayTo) == has);
+            if (dayFrom <= dayTo) {
+                CHECK((snapshot->GetFreeRooms(roomType, dayFrom, dayTo) > 0) == has);
+            }
+            if (has) {
+                hash->Book(userId, roomType, dayFrom, dayTo);
+                bitset->Book(userId, roomType, dayFrom, dayTo);
+                CHECK(hash->HasBooking(userId, roomType, dayFrom, dayTo));
+                CHECK(bitset->HasBooking(userId, roomType, dayFrom, dayTo));
+                if (dayFrom <= dayTo) {
+                    stays.push_back({userId, roomType, dayFrom, dayTo});
+                }
+            }
+
+            // гость уезжает раньше или не приезжает вовсе
+            if (!stays.empty() && random() % 4 == 0) {
+                const auto index = random() % stays.size();
+                auto& stay = stays[index];
+                const unsigned releaseFrom = stay.DayFrom + random() % (stay.DayTo - stay.DayFrom + 1);
+                hash->Release(stay.UserId, stay.RoomType, releaseFrom, stay.DayTo);
+                bitset->Release(stay.UserId, stay.RoomType, releaseFrom, stay.DayTo);
+                CHECK(!hash->HasBooking(stay.UserId, stay.RoomType, releaseFrom, stay.DayTo));
+                CHECK(!bitset->HasBooking(stay.UserId, stay.RoomType, releaseFrom, stay.DayTo));
+                if (releaseFrom == stay.DayFrom) {
+                    stays.erase(stays.begin() + index);
+                } else {
+                    stay.DayTo = releaseFrom - 1;
+                }
+            }
+
+            for (const auto busyType : ROOM_TYPES) {
+                for (unsigned day = 0; day < 280; day += 7) {
+                    const auto busyRooms = hash->GetBusyRooms(busyType, day);
+                    CHECK(bitset->GetBusyRooms(busyType, day) == busyRooms);
+                    CHECK(busyRooms <= roomCounts[busyType]);
+                }
+            }
+        }
+        for (const auto& stay : stays) {
+            CHECK(hash->HasBooking(stay.UserId, stay.RoomType, stay.DayFrom, stay.DayTo));
+            CHECK(bitset->HasBooking(stay.UserId, stay.RoomType, stay.DayFrom, stay.DayTo));
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include "hotel_stats.h"
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    double Ratio(double numerator, double denominator) {
+        return denominator > 0 ? numerator / denominator : 0;
+    }
+}
+
+THotelStats::TTotals& THotelStats::TTotals::operator+=(const TTotals& other) {
+    Days += other.Days;
+    AcceptedBookings += other.AcceptedBookings;
+    TotalBookings += other.TotalBookings;
+    UpgradedBookings += other.UpgradedBookings;
+    Revenue += other.Revenue;
+    for (const auto roomType : ROOM_TYPES) {
+        OccupiedRooms[roomType] += other.OccupiedRooms[roomType];
+    }
+    return *this;
+}
+
+THotelStats::TTotals& THotelStats::TTotals::operator-=(const TTotals& other) {
+    Days -= other.Days;
+    AcceptedBookings -= other.AcceptedBookings;
+    TotalBookings -= other.TotalBookings;
+    UpgradedBookings -= other.UpgradedBookings;
+    Revenue -= other.Revenue;
+    for (const auto roomType : ROOM_TYPES) {
+        OccupiedRooms[roomType] -= other.OccupiedRooms[roomType];
+    }
+    return *this;
+}
+
+THotelStats::THotelStats(TRoomCounts roomCounts, const IBookingSystem& bookingSystem)
+    : RoomCounts(std::move(roomCounts))
+    , TotalRoomCount(std::accumulate(RoomCounts.begin(), RoomCounts.end(), 0u))
+    , BookingSystem(bookingSystem)
+    , LastDays(WINDOW_DAYS.back())
+{
+}
+
+void THotelStats::OnBook(const TBooking& booking, bool success) {
+    ++Today.TotalBookings;
+    if (!success) {
+        return;
+    }
+    ++Today.AcceptedBookings;
+    if (BookingSystem.GetBookedRoomType(booking) != booking.RoomType) {
+        ++Today.UpgradedBookings;
+    }
+}
+
+void THotelStats::OnCheckin(const TBooking& booking, bool success) {
+    if (success) {
+        ++BusyRooms[BookingSystem.GetBookedRoomType(booking)];
+    }
+}
+
+void THotelStats::OnCheckout(const TBooking& booking, TCost cost) {
+    auto& busyRooms = BusyRooms[BookingSystem.GetBookedRoomType(booking)];
+    if (busyRooms == 0) {
+        throw std::runtime_error("Guest " + std::to_string(booking.UserId) + " checks out without checking in");
+    }
+    --busyRooms;
+    Today.Revenue += cost;
+}
+
+void THotelStats::OnDayEnd(unsigned /*day*/) {
+    Today.Days = 1;
+    for (const auto roomType : ROOM_TYPES) {
+        Today.OccupiedRooms[roomType] = BusyRooms[roomType];
+    }
+
+    Total += Today;
+    for (size_t i = 0; i < WINDOW_DAYS.size(); ++i) {
+        Windows[i] += Today;
+        // день, который выпадает из окна, еще лежит в кольцевом буфере
+        if (CompletedDays >= WINDOW_DAYS[i]) {
+            Windows[i] -= LastDays[(CompletedDays - WINDOW_DAYS[i]) % LastDays.size()];
+        }
+    }
+    LastDays[CompletedDays % LastDays.size()] = Today;
+    ++CompletedDays;
+    Today = {};
+}
+
+const THotelStats::TTotals& THotelStats::GetTotals(EWindow window) const {
+    switch (window) {
+        case EWindow::AllTime:
+            return Total;
+        case EWindow::Week:
+            return Windows[0];
+        case EWindow::Month:
+            return Windows[1];
+        case EWindow::Year:
+            return Windows[2];
+    }
+    return Total;
+}
+
+double THotelStats::GetRoomOccupancy(ERoomType roomType, EWindow window) const {
+    const auto& totals = GetTotals(window);
+    return Ratio(totals.OccupiedRooms[roomType], static_cast<double>(RoomCounts[roomType]) * totals.Days);
+}
+
+double THotelStats::GetRoomOccupancy(EWindow window) const {
+    const auto& totals = GetTotals(window);
+    const auto occupiedRooms = std::accumulate(totals.OccupiedRooms.begin(), totals.OccupiedRooms.end(), uint64_t{0});
+    return Ratio(occupiedRooms, static_cast<double>(TotalRoomCount) * totals.Days);
+}
+
+double THotelStats::GetAcceptanceRate(EWindow window) const {
+    const auto& totals = GetTotals(window);
+    return Ratio(totals.AcceptedBookings, totals.TotalBookings);
+}
+
+double THotelStats::GetUpgradeRate(EWindow window) const {
+    const auto& totals = GetTotals(window);
+    return Ratio(totals.UpgradedBookings, totals.AcceptedBookings);
+}
+
+double THotelStats::GetRevPAR(EWindow window) const {
+    const auto& totals = GetTotals(window);
+    return Ratio(totals.Revenue, static_cast<double>(TotalRoomCount) * totals.Days);
+}
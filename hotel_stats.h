@@ -0,0 +1,86 @@
+#pragma once
+
+#include "booking_system.h"
+#include "emulator.h"
+#include "memory_accounting.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Статистика работы гостиницы, которая обновляется по событиям эмулятора за O(1) на событие.
+// Помимо итогов за все время хранит скользящие итоги за последние 7, 30 и 365 дней.
+// Не зависит от интерфейса, поэтому годится и для запусков без окна.
+class THotelStats : public IEmulatorObserver {
+public:
+    enum class EWindow {
+        AllTime,
+        Week,
+        Month,
+        Year
+    };
+
+    // Итоги за отрезок дней
+    struct TTotals {
+        unsigned Days = 0;
+        uint64_t AcceptedBookings = 0;
+        uint64_t TotalBookings = 0;
+        uint64_t UpgradedBookings = 0;
+        uint64_t Revenue = 0;
+        // Сумма занятых на конец дня номеров, то есть число проданных номеро-ночей
+        TRoomTypeMap<uint64_t> OccupiedRooms;
+
+        TTotals& operator+=(const TTotals& other);
+        TTotals& operator-=(const TTotals& other);
+    };
+
+public:
+    // bookingSystem нужна, чтобы узнать, в номер какого типа на самом деле поселен гость
+    THotelStats(TRoomCounts roomCounts, const IBookingSystem& bookingSystem);
+
+    void OnBook(const TBooking& booking, bool success) override;
+    void OnCheckin(const TBooking& booking, bool success) override;
+    void OnCheckout(const TBooking& booking, TCost cost) override;
+    void OnDayEnd(unsigned day) override;
+
+    uint64_t GetAcceptedBookings() const {
+        return Total.AcceptedBookings + Today.AcceptedBookings;
+    }
+
+    uint64_t GetTotalBookings() const {
+        return Total.TotalBookings + Today.TotalBookings;
+    }
+
+    uint64_t GetRevenue() const {
+        return Total.Revenue + Today.Revenue;
+    }
+
+    unsigned GetBusyRooms(ERoomType roomType) const {
+        return BusyRooms.at(roomType);
+    }
+
+    const TTotals& GetTotals(EWindow window = EWindow::AllTime) const;
+
+    // Показатели по завершенным дням окна
+    double GetRoomOccupancy(ERoomType roomType, EWindow window = EWindow::AllTime) const;
+    double GetRoomOccupancy(EWindow window = EWindow::AllTime) const;
+    double GetAcceptanceRate(EWindow window = EWindow::AllTime) const;
+    double GetUpgradeRate(EWindow window = EWindow::AllTime) const;
+    // Выручка на один имеющийся номер в день
+    double GetRevPAR(EWindow window = EWindow::AllTime) const;
+
+private:
+    static constexpr std::array<unsigned, 3> WINDOW_DAYS = {7, 30, 365};
+
+private:
+    const TRoomCounts RoomCounts;
+    const unsigned TotalRoomCount;
+    const IBookingSystem& BookingSystem;
+
+    TRoomCounts BusyRooms;
+    TTotals Today;
+    TTotals Total;
+    std::array<TTotals, WINDOW_DAYS.size()> Windows;
+    // Итоги последних дней, кольцевой буфер длины максимального окна
+    TTrackedVector<TTotals, EMemoryComponent::HotelStats> LastDays;
+    unsigned CompletedDays = 0;
+};
@@ -0,0 +1,390 @@
+#include "booking_protocol.h"
+#include "socket_utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Нагрузочный клиент для booking_server.
+// Закрытая петля: на каждом соединении держится Depth запросов в полете.
+// Открытая петля: запросы уходят по расписанию с суммарной частотой Rate, задержка
+// считается от запланированного момента отправки, чтобы отставание клиента не скрывало
+// задержку сервера.
+namespace {
+    using TClockType = std::chrono::steady_clock;
+
+    constexpr size_t OP_COUNT = 5;
+    constexpr unsigned HORIZON_DAYS = 365;
+    constexpr unsigned MAX_STAY_DAYS = 14;
+    constexpr size_t MAX_CONFIRMED_BOOKINGS = 1024;
+    constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+    constexpr std::chrono::microseconds MIN_SEND_INTERVAL(1);
+
+    struct TOptions {
+        TSocketAddress Address;
+        unsigned Connections = 4;
+        unsigned Depth = 16;
+        // Запросов в секунду на все соединения; 0 - закрытая петля
+        double Rate = 0;
+        double DurationSeconds = 10;
+        uint64_t Seed = 1;
+    };
+
+    struct TOpStats {
+        uint64_t Rejected = 0;
+        uint64_t Errors = 0;
+        std::vector<uint64_t> LatenciesNs;
+    };
+
+    struct TConnectionStats {
+        std::array<TOpStats, OP_COUNT> Ops;
+        uint64_t Sent = 0;
+    };
+
+    struct TPending {
+        EBookingOp Op;
+        TBooking Booking;
+        TClockType::time_point ScheduledAt;
+    };
+
+    uint64_t ToNs(TClockType::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    class TConnectionRunner {
+    public:
+        TConnectionRunner(const TOptions& options, unsigned index, TClockType::time_point start)
+            : Options(options)
+            , Index(index)
+            , Socket(Connect(options.Address))
+            , Random(options.Seed * 1000003 + index)
+            , Start(start)
+            , End(start + std::chrono::duration_cast<TClockType::duration>(std::chrono::duration<double>(options.DurationSeconds)))
+        {
+            SetNonBlocking(Socket.Get());
+            if (Options.Rate > 0) {
+                // не меньше одного тика часов, иначе расписание не сдвинется и цикл отправки не кончится
+                Interval = std::max(
+                    std::chrono::duration_cast<TClockType::duration>(std::chrono::duration<double>(Options.Connections / Options.Rate)),
+                    TClockType::duration(1)
+                );
+            }
+        }
+
+        TConnectionStats Run() {
+            auto nextSend = Start;
+            // после окончания нагрузки ждем ответы на отправленное не дольше секунды
+            const auto drainDeadline = End + std::chrono::seconds(1);
+            while (true) {
+                const auto now = TClockType::now();
+                if (now >= drainDeadline || (now >= End && Pending.empty())) {
+                    break;
+                }
+                if (now < End) {
+                    if (Options.Rate > 0) {
+                        for (; nextSend <= now && nextSend < End; nextSend += Interval) {
+                            Send(nextSend);
+                        }
+                    } else {
+                        while (Pending.size() < Options.Depth) {
+                            Send(now);
+                        }
+                    }
+                }
+                Flush();
+
+                auto wait = drainDeadline - now;
+                if (Options.Rate > 0 && nextSend < End) {
+                    wait = std::min<TClockType::duration>(wait, nextSend - now);
+                }
+                pollfd pollFd = {Socket.Get(), static_cast<short>(POLLIN | (Output.empty() ? 0 : POLLOUT)), 0};
+                const auto waitNs = ToNs(std::max<TClockType::duration>(wait, TClockType::duration::zero()));
+                const timespec timeout = {static_cast<time_t>(waitNs / 1000000000), static_cast<long>(waitNs % 1000000000)};
+                if (ppoll(&pollFd, 1, &timeout, nullptr) < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::string("ppoll: ") + std::strerror(errno));
+                }
+                if (pollFd.revents & (POLLERR | POLLHUP)) {
+                    throw std::runtime_error("Connection closed by server");
+                }
+                if (pollFd.revents & POLLIN) {
+                    Receive();
+                }
+            }
+            return std::move(Stats);
+        }
+
+    private:
+        void Send(TClockType::time_point scheduledAt) {
+            TBookingRequest request;
+            request.RequestId = NextRequestId++;
+            request.Op = ChooseOp();
+            if (request.Op == EBookingOp::GetBill) {
+                request.Booking = Confirmed[Random() % Confirmed.size()];
+            } else {
+                request.Booking = MakeBooking();
+            }
+            SerializeRequest(request, Output);
+            Pending[request.RequestId] = {request.Op, request.Booking, scheduledAt};
+            ++Stats.Sent;
+        }
+
+        // 60% бронирований, 30% запросов свободных номеров, 10% счетов по подтвержденным бронированиям
+        EBookingOp ChooseOp() {
+            const auto dice = Random() % 10;
+            if (dice < 3) {
+                return EBookingOp::GetFreeRooms;
+            }
+            if (dice < 4 && !Confirmed.empty()) {
+                return EBookingOp::GetBill;
+            }
+            return EBookingOp::Book;
+        }
+
+        TBooking MakeBooking() {
+            TBooking booking;
+            booking.UserId = (Index << 24) | (NextUserId++ & 0xFFFFFF);
+            booking.RoomType = ROOM_TYPES[Random() % ROOM_TYPES.size()];
+            booking.DayFrom = Random() % HORIZON_DAYS;
+            booking.DayTo = booking.DayFrom + Random() % MAX_STAY_DAYS;
+            return booking;
+        }
+
+        void Flush() {
+            size_t offset = 0;
+            while (offset < Output.size()) {
+                const auto size = send(Socket.Get(), Output.data() + offset, Output.size() - offset, MSG_NOSIGNAL);
+                if (size < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                    }
+                    throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+                }
+                offset += size;
+            }
+            Output.erase(0, offset);
+        }
+
+        void Receive() {
+            char buffer[READ_CHUNK_SIZE];
+            while (true) {
+                const auto size = recv(Socket.Get(), buffer, sizeof(buffer), 0);
+                if (size == 0) {
+                    throw std::runtime_error("Connection closed by server");
+                }
+                if (size < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                    }
+                    throw std::runtime_error(std::string("recv: ") + std::strerror(errno));
+                }
+                Input.append(buffer, size);
+            }
+
+            const auto now = TClockType::now();
+            size_t offset = 0;
+            for (; offset + BOOKING_RESPONSE_SIZE <= Input.size(); offset += BOOKING_RESPONSE_SIZE) {
+                const auto response = ParseResponse(Input.data() + offset);
+                auto it = Pending.find(response.RequestId);
+                if (it == Pending.end()) {
+                    throw std::runtime_error("Unexpected response id " + std::to_string(response.RequestId));
+                }
+                auto& stats = Stats.Ops[static_cast<size_t>(it->second.Op)];
+                stats.LatenciesNs.push_back(ToNs(now - it->second.ScheduledAt));
+                if (response.Status == EBookingStatus::Rejected) {
+                    ++stats.Rejected;
+                } else if (response.Status == EBookingStatus::BadRequest) {
+                    ++stats.Errors;
+                } else if (it->second.Op == EBookingOp::Book) {
+                    RememberConfirmed(it->second.Booking);
+                }
+                Pending.erase(it);
+            }
+            Input.erase(0, offset);
+        }
+
+        void RememberConfirmed(const TBooking& booking) {
+            if (Confirmed.size() < MAX_CONFIRMED_BOOKINGS) {
+                Confirmed.push_back(booking);
+            } else {
+                Confirmed[Random() % Confirmed.size()] = booking;
+            }
+        }
+
+    private:
+        const TOptions& Options;
+        const unsigned Index;
+        TFileDescriptor Socket;
+        std::mt19937_64 Random;
+        const TClockType::time_point Start;
+        const TClockType::time_point End;
+        TClockType::duration Interval{};
+
+        std::string Input;
+        std::string Output;
+        std::unordered_map<uint32_t, TPending> Pending;
+        std::vector<TBooking> Confirmed;
+        uint32_t NextRequestId = 0;
+        unsigned NextUserId = 0;
+        TConnectionStats Stats;
+    };
+
+    const char* OpName(size_t op) {
+        switch (static_cast<EBookingOp>(op)) {
+            case EBookingOp::Book:
+                return "Book";
+            case EBookingOp::CheckInto:
+                return "CheckInto";
+            case EBookingOp::GetBill:
+                return "GetBill";
+            case EBookingOp::GetFreeRooms:
+                return "GetFreeRooms";
+        }
+        return "Unknown";
+    }
+
+    void PrintLatencies(const char* name, const TOpStats& stats, double seconds, std::ostream& out) {
+        auto latencies = stats.LatenciesNs;
+        if (latencies.empty()) {
+            return;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto quantileUs = [&latencies](double q) {
+            const auto index = std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()));
+            return latencies[index] / 1000.0;
+        };
+        out << std::left << std::setw(14) << name << std::right
+            << std::setw(12) << static_cast<uint64_t>(latencies.size() / seconds)
+            << std::setw(10) << quantileUs(0.5)
+            << std::setw(10) << quantileUs(0.99)
+            << std::setw(10) << quantileUs(0.999)
+            << std::setw(10) << latencies.back() / 1000.0
+            << std::setw(10) << stats.Rejected
+            << std::setw(8) << stats.Errors << "\n";
+    }
+
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--port N | --unix PATH] [--connections N] [--depth N] [--rate REQUESTS_PER_SECOND] [--duration SECONDS] [--seed N]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const auto hasValue = i + 1 < argc;
+            if (!std::strcmp(argv[i], "--port") && hasValue) {
+                options.Address.Port = ParsePort(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--unix") && hasValue) {
+                options.Address.UnixPath = argv[++i];
+            } else if (!std::strcmp(argv[i], "--connections") && hasValue) {
+                options.Connections = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--depth") && hasValue) {
+                options.Depth = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--rate") && hasValue) {
+                options.Rate = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--duration") && hasValue) {
+                options.DurationSeconds = std::stod(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+                options.Seed = std::stoull(argv[++i]);
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (options.Connections == 0 || options.Depth == 0 || options.DurationSeconds <= 0) {
+            throw std::runtime_error("Connections, depth and duration must be positive");
+        }
+        if (!(options.Rate >= 0)) {
+            throw std::runtime_error("Rate must not be negative");
+        }
+        // Соединение в открытой петле отправляет не чаще раза в MIN_SEND_INTERVAL: при более частом
+        // расписании клиент только копит неотправленные запросы
+        const auto maxRate = options.Connections / std::chrono::duration<double>(MIN_SEND_INTERVAL).count();
+        if (options.Rate > maxRate) {
+            throw std::runtime_error(
+                "Rate is too high for " + std::to_string(options.Connections) + " connections, at most " +
+                std::to_string(static_cast<uint64_t>(maxRate)) + " requests per second; add connections"
+            );
+        }
+
+        // Соединения открываются до старта, чтобы установка не попала в замер
+        const auto start = TClockType::now() + std::chrono::milliseconds(100);
+        std::vector<TConnectionRunner> runners;
+        runners.reserve(options.Connections);
+        for (unsigned i = 0; i < options.Connections; ++i) {
+            runners.emplace_back(options, i, start);
+        }
+
+        std::vector<TConnectionStats> results(options.Connections);
+        std::vector<std::exception_ptr> errors(options.Connections);
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < options.Connections; ++i) {
+            threads.emplace_back([&, i] {
+                try {
+                    std::this_thread::sleep_until(start);
+                    results[i] = runners[i].Run();
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        std::array<TOpStats, OP_COUNT> ops;
+        TOpStats total;
+        uint64_t sent = 0;
+        for (auto& result : results) {
+            sent += result.Sent;
+            for (size_t op = 0; op < OP_COUNT; ++op) {
+                auto& from = result.Ops[op];
+                for (auto* to : {&ops[op], &total}) {
+                    to->Rejected += from.Rejected;
+                    to->Errors += from.Errors;
+                    to->LatenciesNs.insert(to->LatenciesNs.end(), from.LatenciesNs.begin(), from.LatenciesNs.end());
+                }
+            }
+        }
+
+        std::cout << (options.Rate > 0 ? "Open loop" : "Closed loop") << ", " << options.Connections << " connections, "
+                  << "sent " << sent << " (" << static_cast<uint64_t>(sent / options.DurationSeconds) << " req/s)"
+                  << ", completed " << total.LatenciesNs.size() << "\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << std::left << std::setw(14) << "op" << std::right
+                  << std::setw(12) << "req/s" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us"
+                  << std::setw(10) << "p999 us" << std::setw(10) << "max us"
+                  << std::setw(10) << "rejected" << std::setw(8) << "errors" << "\n";
+        for (size_t op = 0; op < OP_COUNT; ++op) {
+            PrintLatencies(OpName(op), ops[op], options.DurationSeconds, std::cout);
+        }
+        PrintLatencies("Total", total, options.DurationSeconds, std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,19 @@
 #include "start_window.h"
+#include "trace.h"
 
 #include <QApplication>
+#include <cstdlib>
+#include <optional>
 
 int main(int argc, char *argv[])
 {
+    // BOOKING_TRACE=<file> включает трассировку, трасса пишется в файл по ходу работы
+    const char* tracePath = std::getenv("BOOKING_TRACE");
+    std::optional<TTraceFile> traceFile;
+    if (tracePath) {
+        traceFile.emplace(tracePath);
+    }
+
     QApplication a(argc, argv);
     TStartWindow w;
     w.show();
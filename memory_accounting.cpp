@@ -0,0 +1,90 @@
+#include "memory_accounting.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+    // Счетчики разных компонентов лежат в разных кэш-линиях
+    struct alignas(64) TCounters {
+        std::atomic<uint64_t> Bytes{0};
+        std::atomic<uint64_t> PeakBytes{0};
+        std::atomic<uint64_t> Objects{0};
+        std::atomic<uint64_t> Allocations{0};
+        std::atomic<uint64_t> TotalAllocations{0};
+        std::atomic<uint64_t> Budget{0};
+    };
+
+    TEnumMap<EMemoryComponent, MEMORY_COMPONENTS.size(), TCounters> Counters;
+}
+
+std::string MemoryComponentToString(EMemoryComponent component) {
+    switch (component) {
+        #define X(Id) case EMemoryComponent::Id: return #Id;
+            MEMORY_COMPONENTS_LIST
+        #undef X
+    }
+    throw std::runtime_error("Unknown memory component");
+}
+
+EMemoryComponent MemoryComponentFromString(const std::string& name) {
+    for (const auto component : MEMORY_COMPONENTS) {
+        if (MemoryComponentToString(component) == name) {
+            return component;
+        }
+    }
+    throw std::runtime_error("Unknown memory component " + name);
+}
+
+TMemoryBudgetExceeded::TMemoryBudgetExceeded(EMemoryComponent component, uint64_t budget)
+    : Message("Memory budget of " + MemoryComponentToString(component) + " (" + std::to_string(budget) + " bytes) exceeded")
+{
+}
+
+void TMemoryAccounting::OnAllocate(EMemoryComponent component, size_t bytes, size_t objects) {
+    auto& counters = Counters[component];
+    const auto total = counters.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    const auto budget = counters.Budget.load(std::memory_order_relaxed);
+    if (budget != 0 && total > budget) {
+        counters.Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        throw TMemoryBudgetExceeded(component, budget);
+    }
+    auto peak = counters.PeakBytes.load(std::memory_order_relaxed);
+    while (peak < total && !counters.PeakBytes.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+    }
+    counters.Objects.fetch_add(objects, std::memory_order_relaxed);
+    counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TMemoryAccounting::OnDeallocate(EMemoryComponent component, size_t bytes, size_t objects) noexcept {
+    auto& counters = Counters[component];
+    counters.Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.Objects.fetch_sub(objects, std::memory_order_relaxed);
+    counters.Allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TMemoryAccounting::SetBudget(EMemoryComponent component, uint64_t bytes) {
+    Counters[component].Budget.store(bytes, std::memory_order_relaxed);
+}
+
+uint64_t TMemoryAccounting::GetBudget(EMemoryComponent component) {
+    return Counters[component].Budget.load(std::memory_order_relaxed);
+}
+
+TMemoryUsage TMemoryAccounting::GetUsage(EMemoryComponent component) {
+    const auto& counters = Counters[component];
+    TMemoryUsage usage;
+    usage.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+    usage.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+    usage.Objects = counters.Objects.load(std::memory_order_relaxed);
+    usage.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+    usage.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+TMemoryReport TMemoryAccounting::GetReport() {
+    TMemoryReport report;
+    for (const auto component : MEMORY_COMPONENTS) {
+        report[component] = GetUsage(component);
+    }
+    return report;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "enum_map.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define MEMORY_COMPONENTS_LIST \
+    X(HotelPlan) \
+    X(EmulatorQueues) \
+    X(GuestFrames) \
+    X(AvailabilitySnapshots) \
+    X(HotelStats) \
+    X(ExportBatches)
+
+enum class EMemoryComponent {
+#define X(Id) Id,
+    MEMORY_COMPONENTS_LIST
+#undef X
+};
+
+constexpr std::array MEMORY_COMPONENTS {
+#define X(Id) EMemoryComponent::Id,
+    MEMORY_COMPONENTS_LIST
+#undef X
+};
+
+std::string MemoryComponentToString(EMemoryComponent component);
+// Бросает std::runtime_error для неизвестного имени
+EMemoryComponent MemoryComponentFromString(const std::string& name);
+
+struct TMemoryUsage {
+    uint64_t Bytes = 0;
+    uint64_t PeakBytes = 0;
+    // Сколько элементов помещается в живые выделения; для узловых контейнеров это число узлов
+    uint64_t Objects = 0;
+    uint64_t Allocations = 0;
+    uint64_t TotalAllocations = 0;
+};
+
+using TMemoryReport = TEnumMap<EMemoryComponent, MEMORY_COMPONENTS.size(), TMemoryUsage>;
+
+// Выделение, которое вывело бы компонент за его бюджет
+class TMemoryBudgetExceeded : public std::bad_alloc {
+public:
+    TMemoryBudgetExceeded(EMemoryComponent component, uint64_t budget);
+
+    const char* what() const noexcept override {
+        return Message.c_str();
+    }
+
+private:
+    std::string Message;
+};
+
+// Общие на процесс счетчики памяти по компонентам. Обновляются атомарно из любых потоков.
+class TMemoryAccounting {
+public:
+    // Бросает TMemoryBudgetExceeded, ничего не засчитав, если выделение не влезает в бюджет
+    static void OnAllocate(EMemoryComponent component, size_t bytes, size_t objects);
+    static void OnDeallocate(EMemoryComponent component, size_t bytes, size_t objects) noexcept;
+
+    // 0 - без ограничения
+    static void SetBudget(EMemoryComponent component, uint64_t bytes);
+    static uint64_t GetBudget(EMemoryComponent component);
+
+    static TMemoryUsage GetUsage(EMemoryComponent component);
+    static TMemoryReport GetReport();
+};
+
+// Аллокатор для стандартных контейнеров, засчитывающий память компоненту Component
+template <typename T, EMemoryComponent Component>
+class TTrackingAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TTrackingAllocator<U, Component>;
+    };
+
+public:
+    TTrackingAllocator() noexcept = default;
+
+    template <typename U>
+    TTrackingAllocator(const TTrackingAllocator<U, Component>&) noexcept {
+    }
+
+    T* allocate(size_t count) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned types are not supported");
+        TMemoryAccounting::OnAllocate(Component, count * sizeof(T), count);
+        try {
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        } catch (...) {
+            TMemoryAccounting::OnDeallocate(Component, count * sizeof(T), count);
+            throw;
+        }
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        ::operator delete(pointer);
+        TMemoryAccounting::OnDeallocate(Component, count * sizeof(T), count);
+    }
+
+    template <typename U>
+    bool operator==(const TTrackingAllocator<U, Component>&) const noexcept {
+        return true;
+    }
+};
+
+template <typename T, EMemoryComponent Component>
+using TTrackedVector = std::vector<T, TTrackingAllocator<T, Component>>;
+
+template <typename TKey, typename TValue, EMemoryComponent Component>
+using TTrackedUnorderedMap = std::unordered_map<
+    TKey,
+    TValue,
+    std::hash<TKey>,
+    std::equal_to<TKey>,
+    TTrackingAllocator<std::pair<const TKey, TValue>, Component>
+>;
+
+template <typename TKey, typename TValue, EMemoryComponent Component>
+using TTrackedUnorderedMultimap = std::unordered_multimap<
+    TKey,
+    TValue,
+    std::hash<TKey>,
+    std::equal_to<TKey>,
+    TTrackingAllocator<std::pair<const TKey, TValue>, Component>
+>;
+
+template <typename TKey, EMemoryComponent Component>
+using TTrackedUnorderedSet = std::unordered_set<
+    TKey,
+    std::hash<TKey>,
+    std::equal_to<TKey>,
+    TTrackingAllocator<TKey, Component>
+>;
@@ -0,0 +1,57 @@
+#include "memory_report.h"
+#include <iomanip>
+
+void TMemoryReporter::OnDayEnd(unsigned day) {
+    History.push_back({day, TMemoryAccounting::GetReport()});
+}
+
+void TMemoryReporter::WriteCsv(std::ostream& out) const {
+    out << "day,component,bytes,peak_bytes,objects,allocations,total_allocations\n";
+    for (const auto& daily : History) {
+        for (const auto component : MEMORY_COMPONENTS) {
+            const auto& usage = daily.Report[component];
+            out << daily.Day << ','
+                << MemoryComponentToString(component) << ','
+                << usage.Bytes << ','
+                << usage.PeakBytes << ','
+                << usage.Objects << ','
+                << usage.Allocations << ','
+                << usage.TotalAllocations << '\n';
+        }
+    }
+}
+
+void PrintMemoryReport(const TMemoryReport& report, std::ostream& out) {
+    auto printRow = [&out](const std::string& name, const TMemoryUsage& usage, uint64_t budget) {
+        out << std::left << std::setw(22) << name << std::right
+            << std::setw(14) << usage.Bytes
+            << std::setw(14) << usage.PeakBytes
+            << std::setw(12) << usage.Objects
+            << std::setw(12) << usage.Allocations
+            << std::setw(14) << usage.TotalAllocations;
+        if (budget != 0) {
+            out << std::setw(14) << budget;
+        }
+        out << "\n";
+    };
+
+    out << std::left << std::setw(22) << "component" << std::right
+        << std::setw(14) << "bytes"
+        << std::setw(14) << "peak bytes"
+        << std::setw(12) << "objects"
+        << std::setw(12) << "allocs"
+        << std::setw(14) << "total allocs"
+        << std::setw(14) << "budget" << "\n";
+    TMemoryUsage total;
+    for (const auto component : MEMORY_COMPONENTS) {
+        const auto& usage = report[component];
+        printRow(MemoryComponentToString(component), usage, TMemoryAccounting::GetBudget(component));
+        total.Bytes += usage.Bytes;
+        // сумма пиков компонентов - верхняя оценка общего пика
+        total.PeakBytes += usage.PeakBytes;
+        total.Objects += usage.Objects;
+        total.Allocations += usage.Allocations;
+        total.TotalAllocations += usage.TotalAllocations;
+    }
+    printRow("Total", total, 0);
+}
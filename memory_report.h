@@ -0,0 +1,40 @@
+#pragma once
+
+#include "emulator.h"
+#include "memory_accounting.h"
+#include <ostream>
+#include <vector>
+
+// Снимок счетчиков памяти на конец дня эмуляции
+struct TDailyMemoryReport {
+    unsigned Day = 0;
+    TMemoryReport Report;
+};
+
+// Запоминает отчет о памяти по компонентам на конец каждого дня эмуляции
+class TMemoryReporter : public IEmulatorObserver {
+public:
+    void OnBook(const TBooking& /*booking*/, bool /*success*/) override {
+    }
+
+    void OnCheckin(const TBooking& /*booking*/, bool /*success*/) override {
+    }
+
+    void OnCheckout(const TBooking& /*booking*/, TCost /*cost*/) override {
+    }
+
+    void OnDayEnd(unsigned day) override;
+
+    const std::vector<TDailyMemoryReport>& GetHistory() const {
+        return History;
+    }
+
+    // Строка на день и компонент: day,component,bytes,peak_bytes,objects,allocations,total_allocations
+    void WriteCsv(std::ostream& out) const;
+
+private:
+    std::vector<TDailyMemoryReport> History;
+};
+
+// Таблица по компонентам с бюджетами и итоговой строкой
+void PrintMemoryReport(const TMemoryReport& report, std::ostream& out);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Неблокирующая очередь со многими писателями и одним читателем (алгоритм Вьюкова).
+// Push можно вызывать из любых потоков, Pop и IsEmpty - только из потока-владельца.
+// Освобожденные узлы читатель возвращает в общий список, а писатель забирает его целиком
+// в свой кэш, так что в установившемся режиме Push не обращается к куче.
+template <typename T>
+class TMpscQueue {
+private:
+    struct TNode {
+        std::atomic<TNode*> Next{nullptr};
+        std::optional<T> Value;
+    };
+
+    // Узлы, которые забрал себе поток-писатель. Узлы всех очередей с одним T взаимозаменяемы,
+    // поэтому кэш общий на поток и переживает очереди.
+    struct TNodeCache {
+        TNode* Head = nullptr;
+
+        ~TNodeCache() {
+            DeleteNodes(Head);
+        }
+    };
+
+public:
+    TMpscQueue()
+        : Head(new TNode)
+        , Tail(Head.load())
+    {
+    }
+
+    TMpscQueue(const TMpscQueue&) = delete;
+    TMpscQueue& operator=(const TMpscQueue&) = delete;
+
+    ~TMpscQueue() {
+        while (Pop()) {
+        }
+        delete Tail;
+        DeleteNodes(FreeNodes.load(std::memory_order_acquire));
+    }
+
+    void Push(T value) {
+        auto* node = AllocateNode();
+        try {
+            node->Value.emplace(std::move(value));
+        } catch (...) {
+            ReleaseNode(node);
+            throw;
+        }
+        node->Next.store(nullptr, std::memory_order_relaxed);
+        auto* prev = Head.exchange(node, std::memory_order_acq_rel);
+        prev->Next.store(node, std::memory_order_release);
+    }
+
+    std::optional<T> Pop() {
+        auto* tail = Tail;
+        auto* next = tail->Next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+        // next становится новым фиктивным узлом, значение из него забираем
+        Tail = next;
+        std::optional<T> result = std::move(next->Value);
+        next->Value.reset();
+        ReleaseNode(tail);
+        return result;
+    }
+
+    bool IsEmpty() const {
+        return Tail->Next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    static void DeleteNodes(TNode* node) {
+        while (node) {
+            delete std::exchange(node, node->Next.load(std::memory_order_relaxed));
+        }
+    }
+
+    TNode* AllocateNode() {
+        static thread_local TNodeCache cache;
+        if (!cache.Head) {
+            // список забирается целиком, поэтому ABA здесь невозможна
+            cache.Head = FreeNodes.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (!cache.Head) {
+            return new TNode;
+        }
+        auto* node = cache.Head;
+        cache.Head = node->Next.load(std::memory_order_relaxed);
+        return node;
+    }
+
+    void ReleaseNode(TNode* node) {
+        auto* head = FreeNodes.load(std::memory_order_relaxed);
+        do {
+            node->Next.store(head, std::memory_order_relaxed);
+        } while (!FreeNodes.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+private:
+    std::atomic<TNode*> Head;
+    TNode* Tail;
+    std::atomic<TNode*> FreeNodes{nullptr};
+};
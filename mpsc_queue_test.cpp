@@ -0,0 +1,75 @@
+#include "mpsc_queue.h"
+#include "unit_test.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+    struct TItem {
+        unsigned Producer;
+        unsigned Sequence;
+    };
+}
+
+TEST(MpscQueueKeepsOrder) {
+    TMpscQueue<unsigned> queue;
+    CHECK(queue.IsEmpty());
+    CHECK(!queue.Pop());
+    for (unsigned i = 0; i < 100; ++i) {
+        queue.Push(i);
+    }
+    CHECK(!queue.IsEmpty());
+    for (unsigned i = 0; i < 100; ++i) {
+        const auto value = queue.Pop();
+        CHECK(value && *value == i);
+    }
+    CHECK(queue.IsEmpty());
+    CHECK(!queue.Pop());
+}
+
+// Несколько производителей пишут одновременно с чтением: ни один элемент не теряется
+// и не дублируется, а элементы одного производителя приходят в порядке записи.
+// Второй раунд идет на узлах, возвращенных в свободный список первым
+TEST(MpscQueueSeveralProducers) {
+    constexpr unsigned PRODUCERS = 4;
+    constexpr unsigned ITEMS_PER_PRODUCER = 50000;
+    constexpr unsigned ROUNDS = 2;
+
+    TMpscQueue<TItem> queue;
+    for (unsigned round = 0; round < ROUNDS; ++round) {
+        std::vector<std::thread> producers;
+        for (unsigned producer = 0; producer < PRODUCERS; ++producer) {
+            producers.emplace_back([&queue, producer] {
+                for (unsigned sequence = 0; sequence < ITEMS_PER_PRODUCER; ++sequence) {
+                    queue.Push({producer, sequence});
+                }
+            });
+        }
+
+        std::vector<unsigned> nextSequence(PRODUCERS, 0);
+        unsigned received = 0;
+        bool ordered = true;
+        while (received < PRODUCERS * ITEMS_PER_PRODUCER) {
+            const auto item = queue.Pop();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered = ordered && item->Producer < PRODUCERS && item->Sequence == nextSequence[item->Producer];
+            if (item->Producer < PRODUCERS) {
+                ++nextSequence[item->Producer];
+            }
+            ++received;
+        }
+        for (auto& thread : producers) {
+            thread.join();
+        }
+
+        CHECK(ordered);
+        CHECK(queue.IsEmpty());
+        CHECK(!queue.Pop());
+        for (const auto sequence : nextSequence) {
+            CHECK(sequence == ITEMS_PER_PRODUCER);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include "occupancy_kernels.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OCCUPANCY_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr unsigned BITS_IN_WORD = 64;
+
+    // Маска битов [from, to] внутри одного слова
+    uint64_t RangeMask(unsigned from, unsigned to) {
+        const auto high = to == BITS_IN_WORD - 1 ? ~uint64_t{0} : (uint64_t{1} << (to + 1)) - 1;
+        const auto low = (uint64_t{1} << from) - 1;
+        return high & ~low;
+    }
+
+    bool AllZeroScalar(const uint64_t* words, size_t count) {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < count; ++i) {
+            acc |= words[i];
+        }
+        return acc == 0;
+    }
+
+#ifdef OCCUPANCY_KERNELS_X86
+    __attribute__((target("sse4.1")))
+    bool AllZeroSse(const uint64_t* words, size_t count) {
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i)));
+        }
+        return _mm_testz_si128(acc, acc) && AllZeroScalar(words + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    bool AllZeroAvx2(const uint64_t* words, size_t count) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        size_t i = 0;
+        // 512 дней за итерацию
+        for (; i + 8 <= count; i += 8) {
+            acc0 = _mm256_or_si256(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)));
+            acc1 = _mm256_or_si256(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i + 4)));
+        }
+        if (i + 4 <= count) {
+            acc0 = _mm256_or_si256(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)));
+            i += 4;
+        }
+        acc0 = _mm256_or_si256(acc0, acc1);
+        return _mm256_testz_si256(acc0, acc0) && AllZeroScalar(words + i, count - i);
+    }
+#endif
+
+    using TAllZeroKernel = bool (*)(const uint64_t* words, size_t count);
+
+    struct TKernel {
+        TAllZeroKernel AllZero;
+        const char* Name;
+    };
+
+    bool IsSupported(EOccupancyKernel kernel) {
+        switch (kernel) {
+            case EOccupancyKernel::Scalar:
+                return true;
+#ifdef OCCUPANCY_KERNELS_X86
+            case EOccupancyKernel::Sse41:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse4.1");
+            case EOccupancyKernel::Avx2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+#else
+            case EOccupancyKernel::Sse41:
+            case EOccupancyKernel::Avx2:
+                return false;
+#endif
+        }
+        return false;
+    }
+
+    TKernel GetKernel(EOccupancyKernel kernel) {
+        if (!IsSupported(kernel)) {
+            throw std::runtime_error("Occupancy kernel is not supported by this processor");
+        }
+        switch (kernel) {
+#ifdef OCCUPANCY_KERNELS_X86
+            case EOccupancyKernel::Avx2:
+                return {AllZeroAvx2, "avx2"};
+            case EOccupancyKernel::Sse41:
+                return {AllZeroSse, "sse4.1"};
+#endif
+            default:
+                return {AllZeroScalar, "scalar"};
+        }
+    }
+
+    TKernel SelectKernel() {
+        for (const auto kernel : {EOccupancyKernel::Avx2, EOccupancyKernel::Sse41}) {
+            if (IsSupported(kernel)) {
+                return GetKernel(kernel);
+            }
+        }
+        return GetKernel(EOccupancyKernel::Scalar);
+    }
+
+    const TKernel& GetKernel() {
+        static const TKernel kernel = SelectKernel();
+        return kernel;
+    }
+
+    bool IsRangeFree(TAllZeroKernel allZero, const uint64_t* words, size_t wordsCount, unsigned dayFrom, unsigned dayTo) {
+        if (dayTo < dayFrom) {
+            return true;
+        }
+        const size_t firstWord = dayFrom / BITS_IN_WORD;
+        if (firstWord >= wordsCount) {
+            return true;
+        }
+        const size_t lastWord = std::min<size_t>(dayTo / BITS_IN_WORD, wordsCount - 1);
+        const auto lastBit = lastWord == dayTo / BITS_IN_WORD ? dayTo % BITS_IN_WORD : BITS_IN_WORD - 1;
+
+        if (firstWord == lastWord) {
+            return (words[firstWord] & RangeMask(dayFrom % BITS_IN_WORD, lastBit)) == 0;
+        }
+        if (words[firstWord] & RangeMask(dayFrom % BITS_IN_WORD, BITS_IN_WORD - 1)) {
+            return false;
+        }
+        if (words[lastWord] & RangeMask(0, lastBit)) {
+            return false;
+        }
+        return allZero(words + firstWord + 1, lastWord - firstWord - 1);
+    }
+}
+
+bool IsRangeFree(const uint64_t* words, size_t wordsCount, unsigned dayFrom, unsigned dayTo) {
+    return IsRangeFree(GetKernel().AllZero, words, wordsCount, dayFrom, dayTo);
+}
+
+bool IsRangeFree(EOccupancyKernel kernel, const uint64_t* words, size_t wordsCount, unsigned dayFrom, unsigned dayTo) {
+    return IsRangeFree(GetKernel(kernel).AllZero, words, wordsCount, dayFrom, dayTo);
+}
+
+bool IsOccupancyKernelSupported(EOccupancyKernel kernel) {
+    return IsSupported(kernel);
+}
+
+uint64_t GetRangeMask(size_t word, unsigned dayFrom, unsigned dayTo) {
+    const uint64_t wordFrom = word * BITS_IN_WORD;
+    const uint64_t wordTo = wordFrom + BITS_IN_WORD - 1;
+    if (dayTo < dayFrom || dayTo < wordFrom || dayFrom > wordTo) {
+        return 0;
+    }
+    const auto from = dayFrom > wordFrom ? dayFrom - wordFrom : 0;
+    const auto to = dayTo < wordTo ? dayTo - wordFrom : BITS_IN_WORD - 1;
+    return RangeMask(static_cast<unsigned>(from), static_cast<unsigned>(to));
+}
+
+const char* GetOccupancyKernelName() {
+    return GetKernel().Name;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Битовая карта занятости одного номера: бит day % 64 слова day / 64 выставлен, если номер занят в день day.
+// Биты за пределами карты считаются нулевыми.
+
+enum class EOccupancyKernel {
+    Scalar,
+    Sse41,
+    Avx2
+};
+
+// Проверяет, что номер свободен во все дни отрезка [dayFrom, dayTo].
+// Внутренние слова проверяются векторным ядром (AVX2 или SSE4.1, если их поддерживает процессор).
+bool IsRangeFree(const uint64_t* words, size_t wordsCount, unsigned dayFrom, unsigned dayTo);
+
+// То же на заданном ядре, чтобы сравнивать ядра между собой; ядро должно поддерживаться процессором
+bool IsRangeFree(EOccupancyKernel kernel, const uint64_t* words, size_t wordsCount, unsigned dayFrom, unsigned dayTo);
+bool IsOccupancyKernelSupported(EOccupancyKernel kernel);
+
+// Биты слова word, дни которых попадают в отрезок [dayFrom, dayTo]
+uint64_t GetRangeMask(size_t word, unsigned dayFrom, unsigned dayTo);
+
+// Имя выбранного при запуске ядра: "avx2", "sse4.1" или "scalar"
+const char* GetOccupancyKernelName();
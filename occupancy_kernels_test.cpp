@@ -0,0 +1,61 @@
+#include "occupancy_kernels.h"
+#include "unit_test.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr EOccupancyKernel KERNELS[] = {EOccupancyKernel::Scalar, EOccupancyKernel::Sse41, EOccupancyKernel::Avx2};
+
+    bool IsRangeFreeNaive(const std::vector<uint64_t>& words, unsigned dayFrom, unsigned dayTo) {
+        for (uint64_t day = dayFrom; day <= dayTo; ++day) {
+            if (day / 64 < words.size() && (words[day / 64] >> (day % 64) & 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(RangeMaskMatchesDays) {
+    std::mt19937 random(1);
+    for (int i = 0; i < 10000; ++i) {
+        const size_t word = random() % 8;
+        const unsigned dayFrom = random() % 600;
+        const unsigned dayTo = random() % 8 == 0 ? dayFrom - 1 : dayFrom + random() % 200;
+        const auto mask = GetRangeMask(word, dayFrom, dayTo);
+        for (unsigned bit = 0; bit < 64; ++bit) {
+            const uint64_t day = word * 64 + bit;
+            CHECK(((mask >> bit) & 1) == (dayFrom <= day && day <= dayTo));
+        }
+    }
+}
+
+// Карты почти пустые, чтобы отрезки часто доходили до векторного ядра,
+// и разной длины, чтобы задеть хвосты после 2, 4 и 8 слов
+TEST(OccupancyKernelsMatchScalar) {
+    CHECK(IsOccupancyKernelSupported(EOccupancyKernel::Scalar));
+    std::mt19937 random(2);
+    unsigned checked = 0;
+    for (int map = 0; map < 300; ++map) {
+        std::vector<uint64_t> words(random() % 40);
+        const auto busyBits = random() % 4;
+        for (unsigned i = 0; i < busyBits && !words.empty(); ++i) {
+            const auto day = random() % (words.size() * 64);
+            words[day / 64] |= uint64_t{1} << (day % 64);
+        }
+        for (int range = 0; range < 50; ++range) {
+            const unsigned dayFrom = random() % (words.size() * 64 + 100);
+            const unsigned dayTo = random() % 16 == 0 ? dayFrom - 1 : dayFrom + random() % (words.size() * 64 + 100);
+            const auto expected = dayTo < dayFrom || IsRangeFreeNaive(words, dayFrom, dayTo);
+            CHECK(IsRangeFree(words.data(), words.size(), dayFrom, dayTo) == expected);
+            for (const auto kernel : KERNELS) {
+                if (IsOccupancyKernelSupported(kernel)) {
+                    CHECK(IsRangeFree(kernel, words.data(), words.size(), dayFrom, dayTo) == expected);
+                    ++checked;
+                }
+            }
+        }
+    }
+    CHECK(checked > 0);
+}
@@ -0,0 +1,193 @@
+#include "paired_evaluation.h"
+#include "clock.h"
+#include "emulator.h"
+#include "hotel_stats.h"
+#include "trace.h"
+#include <array>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    constexpr unsigned HOURS_IN_DAY = 24;
+
+    // Раздает всем эмуляторам копию заявок текущего шага
+    class TSharedDemand : public IDemandGenerator {
+    public:
+        explicit TSharedDemand(const std::vector<TDemand>& stepDemands)
+            : StepDemands(stepDemands)
+        {
+        }
+
+        void Generate(IClock::TTime /*currentTime*/, std::vector<TDemand>& demands) override {
+            demands.insert(demands.end(), StepDemands.begin(), StepDemands.end());
+        }
+
+    private:
+        const std::vector<TDemand>& StepDemands;
+    };
+
+    struct TStrategyRun {
+        std::unique_ptr<IBookingSystem> BookingSystem;
+        std::unique_ptr<THotelStats> Stats;
+        std::unique_ptr<IEmulator> Emulator;
+    };
+
+    TStrategyMetrics GetMetrics(const THotelStats& stats) {
+        TStrategyMetrics metrics;
+        metrics.Revenue = stats.GetTotals().Revenue;
+        metrics.Occupancy = stats.GetRoomOccupancy();
+        metrics.AcceptanceRate = stats.GetAcceptanceRate();
+        metrics.UpgradeRate = stats.GetUpgradeRate();
+        metrics.RevPAR = stats.GetRevPAR();
+        return metrics;
+    }
+
+    std::vector<TStrategyMetrics> RunReplica(const TPairedEvaluationConfig& config, unsigned replica) {
+        TRACE_SPAN("PairedEvaluation::RunReplica");
+        TClock clock;
+        auto demandConfig = config.Demand;
+        demandConfig.Seed += replica;
+        auto source = IDemandGenerator::CreateSeasonal(demandConfig, clock.GetTime());
+        auto guestBehaviour = config.GuestBehaviour;
+        guestBehaviour.Seed += replica;
+        std::vector<TDemand> stepDemands;
+
+        std::vector<TStrategyRun> runs;
+        for (const auto strategy : config.Strategies) {
+            TStrategyRun run;
+            run.BookingSystem = IBookingSystem::Create(config.RoomCounts, config.RoomCosts, strategy, clock, config.PlanType);
+            run.Stats = std::make_unique<THotelStats>(config.RoomCounts, *run.BookingSystem);
+            run.Emulator = IEmulator::Create(
+                {*run.BookingSystem, clock},
+                std::make_unique<TSharedDemand>(stepDemands),
+                config.EmulatorType,
+                guestBehaviour
+            );
+            run.Emulator->AddObserver(*run.Stats);
+            if (replica == 0 && runs.empty() && config.FirstReplicaObserver) {
+                run.Emulator->AddObserver(*config.FirstReplicaObserver);
+            }
+            runs.push_back(std::move(run));
+        }
+
+        // Последний шаг приходится на начало дня Days и только закрывает предыдущий день
+        for (unsigned hour = 0; hour <= config.Days * HOURS_IN_DAY; hour += config.StepHours) {
+            stepDemands.clear();
+            source->Generate(clock.GetTime(), stepDemands);
+            for (auto& run : runs) {
+                run.Emulator->MakeStep();
+            }
+            clock.Add(config.StepHours);
+        }
+
+        std::vector<TStrategyMetrics> result;
+        for (const auto& run : runs) {
+            result.push_back(GetMetrics(*run.Stats));
+        }
+        return result;
+    }
+
+    // Квантиль 0.975 распределения Стьюдента
+    double GetStudentQuantile(unsigned degreesOfFreedom) {
+        static constexpr std::array<double, 30> QUANTILES = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        if (degreesOfFreedom == 0) {
+            return 0;
+        }
+        return degreesOfFreedom <= QUANTILES.size() ? QUANTILES[degreesOfFreedom - 1] : 1.96;
+    }
+
+    TEstimate Estimate(const std::vector<double>& values) {
+        TEstimate result;
+        if (values.empty()) {
+            return result;
+        }
+        for (const auto value : values) {
+            result.Mean += value;
+        }
+        result.Mean /= values.size();
+        if (values.size() > 1) {
+            double variance = 0;
+            for (const auto value : values) {
+                variance += (value - result.Mean) * (value - result.Mean);
+            }
+            variance /= values.size() - 1;
+            result.HalfWidth = GetStudentQuantile(values.size() - 1) * std::sqrt(variance / values.size());
+        }
+        return result;
+    }
+
+    template <typename TField>
+    TEstimate EstimateDelta(const std::vector<std::vector<TStrategyMetrics>>& replicas, size_t strategy, TField field) {
+        std::vector<double> deltas;
+        for (const auto& metrics : replicas) {
+            deltas.push_back(metrics[strategy].*field - metrics[0].*field);
+        }
+        return Estimate(deltas);
+    }
+
+    const char* StrategyName(IBookingSystem::EType strategy) {
+        switch (strategy) {
+            case IBookingSystem::EType::Trivial:
+                return "Trivial";
+            case IBookingSystem::EType::Smart:
+                return "Smart";
+        }
+        return "Unknown";
+    }
+}
+
+TPairedEvaluationReport EvaluatePaired(const TPairedEvaluationConfig& config) {
+    if (config.Strategies.empty()) {
+        throw std::runtime_error("At least one strategy is required");
+    }
+    if (config.StepHours == 0 || config.StepHours > HOURS_IN_DAY) {
+        throw std::runtime_error("Step must be from 1 to 24 hours");
+    }
+
+    std::vector<std::vector<TStrategyMetrics>> replicas;
+    for (unsigned replica = 0; replica < config.Replicas; ++replica) {
+        replicas.push_back(RunReplica(config, replica));
+    }
+
+    TPairedEvaluationReport report;
+    report.Replicas = config.Replicas;
+    for (size_t i = 0; i < config.Strategies.size(); ++i) {
+        TStrategyReport strategy;
+        strategy.Strategy = config.Strategies[i];
+        for (const auto& metrics : replicas) {
+            strategy.Mean.Revenue += metrics[i].Revenue / replicas.size();
+            strategy.Mean.Occupancy += metrics[i].Occupancy / replicas.size();
+            strategy.Mean.AcceptanceRate += metrics[i].AcceptanceRate / replicas.size();
+            strategy.Mean.UpgradeRate += metrics[i].UpgradeRate / replicas.size();
+            strategy.Mean.RevPAR += metrics[i].RevPAR / replicas.size();
+        }
+        strategy.RevenueDelta = EstimateDelta(replicas, i, &TStrategyMetrics::Revenue);
+        strategy.OccupancyDelta = EstimateDelta(replicas, i, &TStrategyMetrics::Occupancy);
+        strategy.AcceptanceRateDelta = EstimateDelta(replicas, i, &TStrategyMetrics::AcceptanceRate);
+        strategy.UpgradeRateDelta = EstimateDelta(replicas, i, &TStrategyMetrics::UpgradeRate);
+        strategy.RevPARDelta = EstimateDelta(replicas, i, &TStrategyMetrics::RevPAR);
+        report.Strategies.push_back(strategy);
+    }
+    return report;
+}
+
+void PrintReport(const TPairedEvaluationReport& report, std::ostream& out) {
+    auto printEstimate = [&out](const char* name, double mean, const TEstimate& delta) {
+        out << "  " << name << ": " << mean << " (delta " << delta.Mean << " +- " << delta.HalfWidth << ")\n";
+    };
+
+    out << "Replicas: " << report.Replicas << "\n";
+    for (const auto& strategy : report.Strategies) {
+        out << StrategyName(strategy.Strategy) << "\n";
+        printEstimate("revenue", strategy.Mean.Revenue, strategy.RevenueDelta);
+        printEstimate("occupancy", strategy.Mean.Occupancy, strategy.OccupancyDelta);
+        printEstimate("acceptance rate", strategy.Mean.AcceptanceRate, strategy.AcceptanceRateDelta);
+        printEstimate("upgrade rate", strategy.Mean.UpgradeRate, strategy.UpgradeRateDelta);
+        printEstimate("RevPAR", strategy.Mean.RevPAR, strategy.RevPARDelta);
+    }
+}
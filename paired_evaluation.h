@@ -0,0 +1,64 @@
+#pragma once
+
+#include "booking_system.h"
+#include "demand.h"
+#include "emulator.h"
+#include <ostream>
+#include <vector>
+
+// Парное сравнение стратегий бронирования на общих случайных числах.
+// В каждом прогоне один поток заявок одновременно подается всем стратегиям,
+// поэтому разница между ними не зашумлена разницей в спросе.
+struct TPairedEvaluationConfig {
+    TRoomCounts RoomCounts;
+    TRoomCosts RoomCosts;
+    // Первая стратегия - базовая, с ней сравниваются остальные
+    std::vector<IBookingSystem::EType> Strategies = {IBookingSystem::EType::Trivial, IBookingSystem::EType::Smart};
+    IBookingSystem::EPlanType PlanType = IBookingSystem::EPlanType::Hash;
+    IEmulator::EType EmulatorType = IEmulator::EType::Simple;
+    // Зерно поведения гостей в прогоне r тоже сдвигается на r
+    TGuestBehaviour GuestBehaviour;
+    // Зерно прогона r равно Demand.Seed + r
+    TSeasonalDemandConfig Demand;
+    unsigned Days = 365;
+    unsigned StepHours = 1;
+    unsigned Replicas = 20;
+    // Получает события базовой стратегии в первом прогоне, пока все системы прогона живы,
+    // например чтобы снять отчет о памяти на конец каждого дня
+    IEmulatorObserver* FirstReplicaObserver = nullptr;
+};
+
+struct TStrategyMetrics {
+    double Revenue = 0;
+    double Occupancy = 0;
+    double AcceptanceRate = 0;
+    double UpgradeRate = 0;
+    double RevPAR = 0;
+};
+
+// Среднее и полуширина 95% доверительного интервала
+struct TEstimate {
+    double Mean = 0;
+    double HalfWidth = 0;
+};
+
+struct TStrategyReport {
+    IBookingSystem::EType Strategy;
+    // Средние показатели стратегии по прогонам
+    TStrategyMetrics Mean;
+    // Парные разности с базовой стратегией
+    TEstimate RevenueDelta;
+    TEstimate OccupancyDelta;
+    TEstimate AcceptanceRateDelta;
+    TEstimate UpgradeRateDelta;
+    TEstimate RevPARDelta;
+};
+
+struct TPairedEvaluationReport {
+    unsigned Replicas = 0;
+    std::vector<TStrategyReport> Strategies;
+};
+
+TPairedEvaluationReport EvaluatePaired(const TPairedEvaluationConfig& config);
+
+void PrintReport(const TPairedEvaluationReport& report, std::ostream& out);
@@ -0,0 +1,485 @@
+#include "result_export.h"
+#include "memory_accounting.h"
+#include "trace.h"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Формат .bcol: заголовок, затем блоки по пачкам.
+// Заголовок: "BKCOLS01", u32 число колонок, для каждой колонки u8 ширина значения в байтах,
+// u16 длина имени и само имя. Блок: u32 число строк, затем подряд все значения первой колонки,
+// второй и так далее. Все числа little-endian.
+namespace {
+    constexpr size_t EVENTS_TABLE = 0;
+    constexpr size_t DAYS_TABLE = 1;
+    // Буфер файла: запись идет крупными последовательными кусками
+    constexpr size_t FILE_BUFFER_SIZE = 4 << 20;
+    // Свободных пачек на таблицу: одна заполняется, одна пишется, одна про запас
+    constexpr size_t MAX_FREE_BATCHES = 2;
+
+    struct TColumn {
+        std::string Name;
+        uint8_t Width;
+        // Если задан, в CSV вместо кода пишется Names[value]
+        std::vector<std::string> Names;
+    };
+
+    struct TTableSchema {
+        std::string Name;
+        std::vector<TColumn> Columns;
+    };
+
+    std::vector<std::string> GetRoomTypeNames() {
+        std::vector<std::string> names;
+        for (const auto roomType : ROOM_TYPES) {
+            names.push_back(RoomTypeToString(roomType));
+        }
+        return names;
+    }
+
+    TTableSchema MakeEventsSchema() {
+        const auto roomTypeNames = GetRoomTypeNames();
+        return {"events", {
+            {"day", 4, {}},
+            {"hour", 1, {}},
+            {"event", 1, {"book", "checkin", "checkout"}},
+            {"user_id", 4, {}},
+            {"room_type", 1, roomTypeNames},
+            // тип номера, в который поселен гость; при отказе совпадает с заказанным
+            {"assigned_room_type", 1, roomTypeNames},
+            {"day_from", 4, {}},
+            {"day_to", 4, {}},
+            {"success", 1, {}},
+            {"cost", 4, {}}
+        }};
+    }
+
+    TTableSchema MakeDaysSchema() {
+        TTableSchema schema = {"days", {{"day", 4, {}}}};
+        for (const auto roomType : ROOM_TYPES) {
+            schema.Columns.push_back({"busy_" + RoomTypeToString(roomType), 4, {}});
+        }
+        schema.Columns.push_back({"bookings", 4, {}});
+        schema.Columns.push_back({"accepted_bookings", 4, {}});
+        schema.Columns.push_back({"revenue", 4, {}});
+        return schema;
+    }
+
+    [[noreturn]] void ThrowErrno(const std::string& what) {
+        throw std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    class TOutputFile {
+    public:
+        explicit TOutputFile(const std::string& path)
+            : Path(path)
+            , File(std::fopen(path.c_str(), "wb"))
+            , Buffer(new char[FILE_BUFFER_SIZE])
+        {
+            if (!File) {
+                ThrowErrno("Cannot open " + path);
+            }
+            std::setvbuf(File, Buffer.get(), _IOFBF, FILE_BUFFER_SIZE);
+        }
+
+        ~TOutputFile() {
+            if (File) {
+                std::fclose(File);
+            }
+        }
+
+        TOutputFile(const TOutputFile&) = delete;
+        TOutputFile& operator=(const TOutputFile&) = delete;
+
+        void Write(const void* data, size_t size) {
+            if (std::fwrite(data, 1, size, File) != size) {
+                ThrowErrno("Cannot write " + Path);
+            }
+        }
+
+        void Close() {
+            auto* file = std::exchange(File, nullptr);
+            if (std::fclose(file) != 0) {
+                ThrowErrno("Cannot write " + Path);
+            }
+        }
+
+    private:
+        const std::string Path;
+        std::FILE* File;
+        std::unique_ptr<char[]> Buffer;
+    };
+
+    void AppendUint(std::string& out, uint64_t value, size_t width) {
+        for (size_t i = 0; i < width; ++i) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+}
+
+class TColumnarBatch {
+public:
+    using TColumn = TTrackedVector<uint32_t, EMemoryComponent::ExportBatches>;
+
+public:
+    TColumnarBatch(size_t columnCount, size_t capacity)
+        : Capacity(capacity)
+        , Columns(columnCount)
+    {
+        for (auto& column : Columns) {
+            column.reserve(Capacity);
+        }
+    }
+
+    template <typename TValues>
+    void AddRow(const TValues& values) {
+        auto column = Columns.begin();
+        for (const auto value : values) {
+            (column++)->push_back(value);
+        }
+    }
+
+    size_t GetRowCount() const {
+        return Columns.front().size();
+    }
+
+    bool IsFull() const {
+        return GetRowCount() >= Capacity;
+    }
+
+    const TColumn& GetColumn(size_t column) const {
+        return Columns[column];
+    }
+
+    void Clear() {
+        for (auto& column : Columns) {
+            column.clear();
+        }
+    }
+
+private:
+    const size_t Capacity;
+    std::vector<TColumn> Columns;
+};
+
+// Фоновый писатель: принимает полные пачки и пишет их в файлы своих таблиц
+class TColumnarWriter {
+public:
+    TColumnarWriter(const TExportConfig& config, std::vector<TTableSchema> tables)
+        : Config(config)
+        , Tables(std::move(tables))
+        , FreeBatches(Tables.size())
+    {
+        for (const auto& table : Tables) {
+            const auto path = Config.PathPrefix + "_" + table.Name;
+            if (Config.Csv) {
+                CsvFiles.push_back(std::make_unique<TOutputFile>(path + ".csv"));
+                WriteCsvHeader(table, *CsvFiles.back());
+            }
+            if (Config.Binary) {
+                BinaryFiles.push_back(std::make_unique<TOutputFile>(path + ".bcol"));
+                WriteBinaryHeader(table, *BinaryFiles.back());
+            }
+        }
+        Thread = std::thread([this] { Run(); });
+    }
+
+    ~TColumnarWriter() {
+        try {
+            Close();
+        } catch (...) {
+        }
+    }
+
+    std::unique_ptr<TColumnarBatch> MakeBatch(size_t table) const {
+        return std::make_unique<TColumnarBatch>(Tables[table].Columns.size(), Config.BatchRows);
+    }
+
+    // Забирает полную пачку и сразу подменяет ее пустой, не дожидаясь записи
+    void Submit(size_t table, std::unique_ptr<TColumnarBatch>& batch) {
+        if (Failed.load(std::memory_order_relaxed)) {
+            Close();
+        }
+        std::unique_ptr<TColumnarBatch> empty;
+        {
+            std::lock_guard<std::mutex> guard(Mutex);
+            Pending.emplace_back(table, std::move(batch));
+            auto& freeBatches = FreeBatches[table];
+            if (!freeBatches.empty()) {
+                empty = std::move(freeBatches.back());
+                freeBatches.pop_back();
+            }
+        }
+        HasPending.notify_one();
+        batch = empty ? std::move(empty) : MakeBatch(table);
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> guard(Mutex);
+            Stopping = true;
+        }
+        HasPending.notify_one();
+        if (Thread.joinable()) {
+            Thread.join();
+            if (!Error) {
+                try {
+                    for (auto* files : {&CsvFiles, &BinaryFiles}) {
+                        for (auto& file : *files) {
+                            file->Close();
+                        }
+                    }
+                } catch (...) {
+                    Error = std::current_exception();
+                }
+            }
+        }
+        if (Error) {
+            std::rethrow_exception(Error);
+        }
+    }
+
+private:
+    void Run() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(Mutex);
+            HasPending.wait(lock, [this] { return !Pending.empty() || Stopping; });
+            if (Pending.empty()) {
+                return;
+            }
+            auto [table, batch] = std::move(Pending.front());
+            Pending.pop_front();
+            lock.unlock();
+
+            if (!Error) {
+                try {
+                    Write(table, *batch);
+                } catch (...) {
+                    Error = std::current_exception();
+                    Failed.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            batch->Clear();
+            lock.lock();
+            if (FreeBatches[table].size() < MAX_FREE_BATCHES) {
+                FreeBatches[table].push_back(std::move(batch));
+            }
+        }
+    }
+
+    void Write(size_t table, const TColumnarBatch& batch) {
+        TRACE_SPAN("ColumnarWriter::Write");
+        if (Config.Csv) {
+            WriteCsv(Tables[table], batch, *CsvFiles[table]);
+        }
+        if (Config.Binary) {
+            WriteBinary(Tables[table], batch, *BinaryFiles[table]);
+        }
+    }
+
+    void WriteCsvHeader(const TTableSchema& table, TOutputFile& file) {
+        std::string text;
+        for (size_t i = 0; i < table.Columns.size(); ++i) {
+            text += (i ? "," : "") + table.Columns[i].Name;
+        }
+        text += '\n';
+        file.Write(text.data(), text.size());
+    }
+
+    void WriteCsv(const TTableSchema& table, const TColumnarBatch& batch, TOutputFile& file) {
+        Text.clear();
+        const auto rows = batch.GetRowCount();
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t i = 0; i < table.Columns.size(); ++i) {
+                if (i) {
+                    Text.push_back(',');
+                }
+                const auto value = batch.GetColumn(i)[row];
+                const auto& names = table.Columns[i].Names;
+                if (value < names.size()) {
+                    Text += names[value];
+                } else {
+                    char digits[16];
+                    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+                    Text.append(digits, end);
+                }
+            }
+            Text.push_back('\n');
+        }
+        file.Write(Text.data(), Text.size());
+    }
+
+    void WriteBinaryHeader(const TTableSchema& table, TOutputFile& file) {
+        std::string header = "BKCOLS01";
+        AppendUint(header, table.Columns.size(), 4);
+        for (const auto& column : table.Columns) {
+            AppendUint(header, column.Width, 1);
+            AppendUint(header, column.Name.size(), 2);
+            header += column.Name;
+        }
+        file.Write(header.data(), header.size());
+    }
+
+    void WriteBinary(const TTableSchema& table, const TColumnarBatch& batch, TOutputFile& file) {
+        Text.clear();
+        const auto rows = batch.GetRowCount();
+        AppendUint(Text, rows, 4);
+        for (size_t i = 0; i < table.Columns.size(); ++i) {
+            const auto width = table.Columns[i].Width;
+            const auto offset = Text.size();
+            Text.resize(offset + rows * width);
+            auto* out = &Text[offset];
+            for (const auto value : batch.GetColumn(i)) {
+                for (size_t byte = 0; byte < width; ++byte) {
+                    *out++ = static_cast<char>(value >> (8 * byte));
+                }
+            }
+        }
+        file.Write(Text.data(), Text.size());
+    }
+
+private:
+    const TExportConfig Config;
+    const std::vector<TTableSchema> Tables;
+    std::vector<std::unique_ptr<TOutputFile>> CsvFiles;
+    std::vector<std::unique_ptr<TOutputFile>> BinaryFiles;
+    // Буфер кодирования, используется только потоком писателя
+    std::string Text;
+
+    std::mutex Mutex;
+    std::condition_variable HasPending;
+    std::deque<std::pair<size_t, std::unique_ptr<TColumnarBatch>>> Pending;
+    std::vector<std::vector<std::unique_ptr<TColumnarBatch>>> FreeBatches;
+    bool Stopping = false;
+
+    std::atomic_bool Failed{false};
+    std::exception_ptr Error;
+    std::thread Thread;
+};
+
+TResultExporter::TResultExporter(
+    const TExportConfig& config,
+    const IBookingSystem& bookingSystem,
+    const IClock& clock,
+    const THotelStats& hotelStats
+)
+    : BookingSystem(bookingSystem)
+    , Clock(clock)
+    , HotelStats(hotelStats)
+{
+    if (config.PathPrefix.empty()) {
+        throw std::runtime_error("Export path prefix is empty");
+    }
+    if (config.BatchRows == 0) {
+        throw std::runtime_error("Export batch size must be positive");
+    }
+    Writer = std::make_unique<TColumnarWriter>(config, std::vector<TTableSchema>{MakeEventsSchema(), MakeDaysSchema()});
+    Events = Writer->MakeBatch(EVENTS_TABLE);
+    Days = Writer->MakeBatch(DAYS_TABLE);
+}
+
+TResultExporter::~TResultExporter() {
+    try {
+        Close();
+    } catch (...) {
+    }
+}
+
+void TResultExporter::OnBook(const TBooking& booking, bool success) {
+    AddEvent(EEvent::Book, booking, success, 0);
+}
+
+void TResultExporter::OnCheckin(const TBooking& booking, bool success) {
+    AddEvent(EEvent::Checkin, booking, success, 0);
+}
+
+void TResultExporter::OnCheckout(const TBooking& booking, TCost cost) {
+    AddEvent(EEvent::Checkout, booking, true, cost);
+}
+
+void TResultExporter::OnDayEnd(unsigned day) {
+    if (!Writer) {
+        return;
+    }
+    // Итоги за все время не зависят от того, обработала ли статистика конец дня раньше нас
+    const auto totalBookings = HotelStats.GetTotalBookings();
+    const auto acceptedBookings = HotelStats.GetAcceptedBookings();
+    const auto revenue = HotelStats.GetRevenue();
+    // колонки как в MakeDaysSchema
+    std::array<uint32_t, ROOM_TYPES.size() + 4> row;
+    auto value = row.begin();
+    *value++ = day;
+    for (const auto roomType : ROOM_TYPES) {
+        *value++ = HotelStats.GetBusyRooms(roomType);
+    }
+    *value++ = static_cast<uint32_t>(totalBookings - LastTotalBookings);
+    *value++ = static_cast<uint32_t>(acceptedBookings - LastAcceptedBookings);
+    *value++ = static_cast<uint32_t>(revenue - LastRevenue);
+    Days->AddRow(row);
+    LastTotalBookings = totalBookings;
+    LastAcceptedBookings = acceptedBookings;
+    LastRevenue = revenue;
+    if (Days->IsFull()) {
+        Submit(DAYS_TABLE, Days);
+    }
+}
+
+void TResultExporter::Flush() {
+    if (!Writer) {
+        return;
+    }
+    if (Events->GetRowCount() > 0) {
+        Submit(EVENTS_TABLE, Events);
+    }
+    if (Days->GetRowCount() > 0) {
+        Submit(DAYS_TABLE, Days);
+    }
+}
+
+void TResultExporter::Close() {
+    if (!Writer) {
+        return;
+    }
+    Flush();
+    auto writer = std::move(Writer);
+    writer->Close();
+}
+
+void TResultExporter::AddEvent(EEvent event, const TBooking& booking, bool success, TCost cost) {
+    if (!Writer) {
+        return;
+    }
+    const auto time = Clock.GetTime();
+    const auto assignedRoomType = success ? BookingSystem.GetBookedRoomType(booking) : booking.RoomType;
+    Events->AddRow(std::array<uint32_t, 10>{
+        time.Day,
+        time.Hour,
+        static_cast<uint32_t>(event),
+        booking.UserId,
+        static_cast<uint32_t>(booking.RoomType),
+        static_cast<uint32_t>(assignedRoomType),
+        booking.DayFrom,
+        booking.DayTo,
+        success,
+        cost
+    });
+    if (Events->IsFull()) {
+        Submit(EVENTS_TABLE, Events);
+    }
+}
+
+void TResultExporter::Submit(size_t table, std::unique_ptr<TColumnarBatch>& batch) {
+    Writer->Submit(table, batch);
+}
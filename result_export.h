@@ -0,0 +1,75 @@
+#pragma once
+
+#include "booking_system.h"
+#include "clock.h"
+#include "emulator.h"
+#include "hotel_stats.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct TExportConfig {
+    // Таблицы пишутся в <PathPrefix>_events.* и <PathPrefix>_days.*
+    std::string PathPrefix;
+    bool Csv = true;
+    // Колоночный формат .bcol, см. result_export.cpp
+    bool Binary = true;
+    // Сколько строк поток эмуляции накапливает, прежде чем отдать пачку писателю
+    size_t BatchRows = 1 << 16;
+};
+
+class TColumnarBatch;
+class TColumnarWriter;
+
+// Сохраняет все события эмуляции и ежедневную загрузку номеров в колоночные файлы.
+// Поток эмуляции только дописывает строки в текущую пачку и меняет полную пачку на пустую,
+// а кодирование и запись на диск идут в отдельном потоке. Если писатель не успевает,
+// эмуляция не ждет его, а заводит новую пачку.
+class TResultExporter : public IEmulatorObserver {
+public:
+    // Занятость и итоги дня берутся из hotelStats, который должен получать те же события
+    TResultExporter(
+        const TExportConfig& config,
+        const IBookingSystem& bookingSystem,
+        const IClock& clock,
+        const THotelStats& hotelStats
+    );
+    ~TResultExporter() override;
+
+    TResultExporter(const TResultExporter&) = delete;
+    TResultExporter& operator=(const TResultExporter&) = delete;
+
+    void OnBook(const TBooking& booking, bool success) override;
+    void OnCheckin(const TBooking& booking, bool success) override;
+    void OnCheckout(const TBooking& booking, TCost cost) override;
+    void OnDayEnd(unsigned day) override;
+
+    // Отдает писателю неполные пачки, не дожидаясь записи
+    void Flush();
+    // Дописывает все накопленное и закрывает файлы. Бросает исключение, если запись не удалась.
+    void Close();
+
+private:
+    enum class EEvent : uint32_t {
+        Book,
+        Checkin,
+        Checkout
+    };
+
+private:
+    void AddEvent(EEvent event, const TBooking& booking, bool success, TCost cost);
+    void Submit(size_t table, std::unique_ptr<TColumnarBatch>& batch);
+
+private:
+    const IBookingSystem& BookingSystem;
+    const IClock& Clock;
+    const THotelStats& HotelStats;
+    std::unique_ptr<TColumnarWriter> Writer;
+    std::unique_ptr<TColumnarBatch> Events;
+    std::unique_ptr<TColumnarBatch> Days;
+
+    // Итоги статистики на конец предыдущего дня
+    uint64_t LastTotalBookings = 0;
+    uint64_t LastAcceptedBookings = 0;
+    uint64_t LastRevenue = 0;
+};
@@ -0,0 +1,102 @@
+#include "booking_server.h"
+#include "trace.h"
+
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    TBookingServer* RunningServer = nullptr;
+
+    void HandleSignal(int /*signal*/) {
+        if (RunningServer) {
+            RunningServer->Stop();
+        }
+    }
+
+    void PrintUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--port N | --unix PATH] [--trivial] [--bitset] [--scale N] [--batch N] [--trace FILE]"
+                  << " [--horizon DAYS] [--max-stay DAYS]\n"
+                  << "  --bitset  keep occupancy in bit layers instead of hash sets; decisions are the same\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TSocketAddress address;
+    auto type = IBookingSystem::EType::Smart;
+    auto planType = IBookingSystem::EPlanType::Hash;
+    unsigned scale = 1;
+    size_t maxBatchSize = 256;
+    TBookingLimits limits;
+    std::string tracePath;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const auto hasValue = i + 1 < argc;
+            if (!std::strcmp(argv[i], "--port") && hasValue) {
+                address.Port = ParsePort(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--unix") && hasValue) {
+                address.UnixPath = argv[++i];
+            } else if (!std::strcmp(argv[i], "--trivial")) {
+                type = IBookingSystem::EType::Trivial;
+            } else if (!std::strcmp(argv[i], "--bitset")) {
+                planType = IBookingSystem::EPlanType::Bitset;
+            } else if (!std::strcmp(argv[i], "--scale") && hasValue) {
+                scale = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--batch") && hasValue) {
+                maxBatchSize = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--trace") && hasValue) {
+                tracePath = argv[++i];
+            } else if (!std::strcmp(argv[i], "--horizon") && hasValue) {
+                limits.HorizonDays = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--max-stay") && hasValue) {
+                limits.MaxStayDays = std::stoul(argv[++i]);
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (limits.HorizonDays == 0 || limits.MaxStayDays == 0) {
+            throw std::runtime_error("Horizon and maximum stay must be positive");
+        }
+
+        // те же значения, что по умолчанию в окне эмуляции, число номеров умножается на scale
+        const TRoomCounts roomCounts = {
+            {ERoomType::Single, 12 * scale},
+            {ERoomType::Double, 8 * scale},
+            {ERoomType::DoubleWithSofa, 4 * scale},
+            {ERoomType::HalfLux, 2 * scale},
+            {ERoomType::Lux, 1 * scale}
+        };
+        const TRoomCosts roomCosts = {
+            {ERoomType::Single, 3000},
+            {ERoomType::Double, 4500},
+            {ERoomType::DoubleWithSofa, 5000},
+            {ERoomType::HalfLux, 8000},
+            {ERoomType::Lux, 10000}
+        };
+
+        // Время сервера стоит на нулевом дне
+        TClock clock;
+        auto bookingSystem = IBookingSystem::Create(roomCounts, roomCosts, type, clock, planType);
+        std::optional<TTraceFile> traceFile;
+        if (!tracePath.empty()) {
+            traceFile.emplace(tracePath);
+        }
+        TBookingServer server(*bookingSystem, address, maxBatchSize, limits);
+
+        RunningServer = &server;
+        std::signal(SIGINT, HandleSignal);
+        std::signal(SIGTERM, HandleSignal);
+        server.Run();
+        RunningServer = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
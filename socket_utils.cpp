@@ -0,0 +1,132 @@
+#include "socket_utils.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+    [[noreturn]] void ThrowErrno(const std::string& what) {
+        throw std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    sockaddr_un MakeUnixAddress(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Unix socket path is too long: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    sockaddr_in MakeLoopbackAddress(uint16_t port) {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+
+    TFileDescriptor MakeSocket(const TSocketAddress& address) {
+        TFileDescriptor fd(socket(address.UnixPath.empty() ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!fd) {
+            ThrowErrno("socket");
+        }
+        return fd;
+    }
+}
+
+uint16_t ParsePort(const std::string& value) {
+    size_t parsed = 0;
+    unsigned long port = 0;
+    try {
+        port = std::stoul(value, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
+    }
+    if (parsed == 0 || parsed != value.size() || port == 0 || port > UINT16_MAX) {
+        throw std::runtime_error("Port must be from 1 to 65535, got " + value);
+    }
+    return static_cast<uint16_t>(port);
+}
+
+TFileDescriptor::TFileDescriptor(TFileDescriptor&& other) noexcept
+    : Fd(std::exchange(other.Fd, -1))
+{
+}
+
+TFileDescriptor& TFileDescriptor::operator=(TFileDescriptor&& other) noexcept {
+    if (this != &other) {
+        if (Fd >= 0) {
+            close(Fd);
+        }
+        Fd = std::exchange(other.Fd, -1);
+    }
+    return *this;
+}
+
+TFileDescriptor::~TFileDescriptor() {
+    if (Fd >= 0) {
+        close(Fd);
+    }
+}
+
+TFileDescriptor Listen(const TSocketAddress& address) {
+    auto fd = MakeSocket(address);
+    int result = 0;
+    if (address.UnixPath.empty()) {
+        const int enable = 1;
+        setsockopt(fd.Get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        const auto inetAddress = MakeLoopbackAddress(address.Port);
+        result = bind(fd.Get(), reinterpret_cast<const sockaddr*>(&inetAddress), sizeof(inetAddress));
+    } else {
+        const auto unixAddress = MakeUnixAddress(address.UnixPath);
+        unlink(address.UnixPath.c_str());
+        result = bind(fd.Get(), reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress));
+    }
+    if (result < 0) {
+        ThrowErrno("bind");
+    }
+    if (listen(fd.Get(), SOMAXCONN) < 0) {
+        ThrowErrno("listen");
+    }
+    SetNonBlocking(fd.Get());
+    return fd;
+}
+
+TFileDescriptor Connect(const TSocketAddress& address) {
+    auto fd = MakeSocket(address);
+    int result = 0;
+    if (address.UnixPath.empty()) {
+        const auto inetAddress = MakeLoopbackAddress(address.Port);
+        result = connect(fd.Get(), reinterpret_cast<const sockaddr*>(&inetAddress), sizeof(inetAddress));
+    } else {
+        const auto unixAddress = MakeUnixAddress(address.UnixPath);
+        result = connect(fd.Get(), reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress));
+    }
+    if (result < 0) {
+        ThrowErrno("connect");
+    }
+    SetNoDelay(fd.Get());
+    return fd;
+}
+
+void SetNonBlocking(int fd) {
+    const auto flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        ThrowErrno("fcntl");
+    }
+}
+
+void SetNoDelay(int fd) {
+    // У unix-сокетов такой опции нет, ошибку можно не проверять
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
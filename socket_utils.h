@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Адрес сервера: unix-сокет, если задан UnixPath, иначе TCP на 127.0.0.1:Port
+struct TSocketAddress {
+    std::string UnixPath;
+    uint16_t Port = 7340;
+};
+
+// Номер TCP-порта из строки; бросает std::runtime_error, если это не число от 1 до 65535
+uint16_t ParsePort(const std::string& value);
+
+// Владеет файловым дескриптором и закрывает его в деструкторе
+class TFileDescriptor {
+public:
+    TFileDescriptor() = default;
+
+    explicit TFileDescriptor(int fd)
+        : Fd(fd)
+    {
+    }
+
+    TFileDescriptor(TFileDescriptor&& other) noexcept;
+    TFileDescriptor& operator=(TFileDescriptor&& other) noexcept;
+    ~TFileDescriptor();
+
+    int Get() const {
+        return Fd;
+    }
+
+    explicit operator bool() const {
+        return Fd >= 0;
+    }
+
+private:
+    int Fd = -1;
+};
+
+// При ошибке бросают std::runtime_error с текстом errno
+TFileDescriptor Listen(const TSocketAddress& address);
+TFileDescriptor Connect(const TSocketAddress& address);
+void SetNonBlocking(int fd);
+// Отключает алгоритм Нейгла, чтобы мелкие кадры уходили сразу; ошибки игнорирует
+void SetNoDelay(int fd);
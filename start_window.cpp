@@ -4,12 +4,13 @@
 #include <QDebug>
 
 #include "emulator.h"
+#include "trace.h"
+#include <cstdlib>
+#include <fstream>
 #include <mutex>
 #include <sstream>
 
 namespace  {
-    constexpr unsigned HOURS_IN_DAY = 24;
-
     enum ECase {
         Nominative,
         Genitive,
@@ -72,15 +73,6 @@ namespace  {
     }
 }
 
-IClock::TTime TClock::GetTime() const {
-    const auto value = Hours.load();
-    return {value / HOURS_IN_DAY, value % HOURS_IN_DAY};
-}
-
-void TClock::Add(unsigned additionalHours) {
-    Hours += additionalHours;
-}
-
 TStartWindow::TStartWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::TStartWindow)
@@ -113,19 +105,34 @@ TStartWindow::~TStartWindow() {
 
 void TStartWindow::on_StartEmulate_clicked() {
     try {
+        // старый эмулятор ссылается на объекты, которые сейчас будут пересозданы
+        Emulator.reset();
+        ResultExporter.reset();
+
         InitRoomCounts();
         InitRoomCosts();
-        for (const auto roomType : ROOM_TYPES) {
-            BusyRooms[roomType] = 0;
-        }
-        TotalProfit = 0;
-        HotelStats = std::make_unique<THotelStats>(RoomCounts);
 
         ui->ActionView->clear();
 
         Clock = std::make_unique<TClock>();
         BookingSystem = IBookingSystem::Create(RoomCounts, RoomCosts, GetBookingSystemType(), *Clock);
+        HotelStats = std::make_unique<THotelStats>(RoomCounts, *BookingSystem);
+        MemoryReporter = std::make_unique<TMemoryReporter>();
+        MemoryReportPath.clear();
+        // BOOKING_EXPORT=<префикс> сохраняет события, загрузку и память по дням в файлы <префикс>_*
+        if (const char* exportPrefix = std::getenv("BOOKING_EXPORT")) {
+            TExportConfig exportConfig;
+            exportConfig.PathPrefix = exportPrefix;
+            ResultExporter = std::make_unique<TResultExporter>(exportConfig, *BookingSystem, *Clock, *HotelStats);
+            MemoryReportPath = std::string(exportPrefix) + "_memory.csv";
+        }
         Emulator = IEmulator::Create({*BookingSystem, *Clock});
+        // статистика должна обновиться раньше, чем окно ее покажет
+        Emulator->AddObserver(*HotelStats);
+        Emulator->AddObserver(*MemoryReporter);
+        if (ResultExporter) {
+            Emulator->AddObserver(*ResultExporter);
+        }
         Emulator->AddObserver(*this);
 
         DisplayRoomCounts();
@@ -137,6 +144,7 @@ void TStartWindow::on_StartEmulate_clicked() {
 }
 
 void TStartWindow::on_MakeStep_clicked() {
+    TRACE_SPAN("StartWindow::MakeStep");
     if (!Emulator) {
         return;
     }
@@ -145,16 +153,8 @@ void TStartWindow::on_MakeStep_clicked() {
         ClearEvents();
         Emulator->MakeStep();
         DisplayLastEvents();
-        const auto dayBeforeAdd = Clock->GetTime().Day;
         Clock->Add(step);
         const auto dayAfterAdd = Clock->GetTime().Day;
-        if (dayBeforeAdd != dayAfterAdd) {
-            for (const auto roomType : ROOM_TYPES) {
-                const auto totalCount = RoomCounts.at(roomType);
-                const auto busyCount = BusyRooms.at(roomType);
-                HotelStats->AddRoomsOccupanccy(roomType, dayBeforeAdd, static_cast<double>(busyCount) / totalCount);
-            }
-        }
         DisplayTime();
         if (EmulationTimer.isActive() && dayAfterAdd > GetDaysToEmulate()) {
             on_StopEmulation_clicked();
@@ -166,6 +166,17 @@ void TStartWindow::on_MakeStep_clicked() {
 
 void TStartWindow::on_StopEmulation_clicked() {
     EmulationTimer.stop();
+    if (ResultExporter) {
+        try {
+            ResultExporter->Flush();
+        } catch (const std::exception& e) {
+            ReportError(e.what());
+        }
+    }
+    if (MemoryReporter && !MemoryReportPath.empty()) {
+        std::ofstream memoryReport(MemoryReportPath);
+        MemoryReporter->WriteCsv(memoryReport);
+    }
     DisplayStat();
 }
 
@@ -245,34 +256,29 @@ void TStartWindow::InitRoomCosts() {
 
 void TStartWindow::OnBook(const TBooking& booking, bool success) {
     Bookings.push_back({booking, success});
-    if (success) {
-        HotelStats->AddAcceptedBooking();
-    } else {
-        HotelStats->AddRejectedBooking();
-    }
 }
 
 void TStartWindow::OnCheckin(const TBooking& booking, bool success) {
-    if (success) {
-        ++BusyRooms[booking.RoomType];
-    }
     Checkins.push_back({booking, success});
     DisplayRoomCounts();
 }
 
 void TStartWindow::OnCheckout(const TBooking& booking, TCost cost) {
-    --BusyRooms[booking.RoomType];
-    TotalProfit += cost;
     Checkouts.push_back({booking, cost});
     DisplayRoomCounts();
     DisplayProfit();
 }
 
+void TStartWindow::OnDayEnd(unsigned /*day*/) {
+}
+
 void TStartWindow::DisplayRoomCounts() {
+    TRACE_SPAN("StartWindow::DisplayRoomCounts");
     for (const auto roomType : ROOM_TYPES) {
-        const auto freeRooms = RoomCounts.at(roomType) - BusyRooms.at(roomType);
+        const auto busyRooms = HotelStats->GetBusyRooms(roomType);
+        const auto freeRooms = RoomCounts.at(roomType) - busyRooms;
         OutputsOfFreeRooms[roomType]->setText(QString::number(freeRooms));
-        OutputsOfBusyRooms[roomType]->setText(QString::number(BusyRooms.at(roomType)));
+        OutputsOfBusyRooms[roomType]->setText(QString::number(busyRooms));
     }
 }
 
@@ -284,7 +290,7 @@ void TStartWindow::DisplayTime() {
 }
 
 void TStartWindow::DisplayProfit() {
-    ui->TotalHotelProfit->setText(QString::number(TotalProfit) + " руб");
+    ui->TotalHotelProfit->setText(QString::number(HotelStats->GetRevenue()) + " руб");
 }
 
 void TStartWindow::ClearEvents() {
@@ -294,6 +300,7 @@ void TStartWindow::ClearEvents() {
 }
 
 void TStartWindow::DisplayLastEvents() {
+    TRACE_SPAN("StartWindow::DisplayLastEvents");
     std::vector<std::string> events;
     for (const auto& booking : Bookings) {
         events.push_back("<center><b>" + BuildBookingEventText(booking) + "</b></center>");
@@ -321,6 +328,18 @@ void TStartWindow::DisplayStat() {
         text << "    " << RussianRoomType(roomType, ECase::Nominative) << ": " << HotelStats->GetRoomOccupancy(roomType) * 100 << "%<br>";
     }
     text << "    Гостиница в целом:" << HotelStats->GetRoomOccupancy() * 100 << "%<br>";
+    text << "Загрузка за последние 7 дней: " << HotelStats->GetRoomOccupancy(THotelStats::EWindow::Week) * 100 << "%<br>";
+    text << "Загрузка за последние 30 дней: " << HotelStats->GetRoomOccupancy(THotelStats::EWindow::Month) * 100 << "%<br>";
+    text << "Доля подтвержденных бронирований: " << HotelStats->GetAcceptanceRate() * 100 << "%<br>";
+    text << "Доля поселений в номер лучше заказанного: " << HotelStats->GetUpgradeRate() * 100 << "%<br>";
+    text << "Выручка на номер в день (RevPAR): " << HotelStats->GetRevPAR() << " руб<br>";
+    text << "Память по компонентам (байт, пик, объектов):<br>";
+    const auto memoryReport = TMemoryAccounting::GetReport();
+    for (const auto component : MEMORY_COMPONENTS) {
+        const auto& usage = memoryReport[component];
+        text << "    " << MemoryComponentToString(component) << ": "
+             << usage.Bytes << ", " << usage.PeakBytes << ", " << usage.Objects << "<br>";
+    }
     ui->ActionView->setHtml(QString::fromStdString(text.str()));
 }
 
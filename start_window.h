@@ -3,23 +3,19 @@
 #include <QLineEdit>
 #include <QMainWindow>
 #include <QTimer>
+#include "clock.h"
 #include "emulator.h"
+#include "hotel_stats.h"
+#include "memory_report.h"
+#include "result_export.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class TStartWindow; }
 QT_END_NAMESPACE
 
-class TClock : public IClock {
-public:
-    TTime GetTime() const override;
-
-    void Add(unsigned additionalHours);
-
-private:
-    std::atomic_uint Hours{0};
-};
-
 struct TBookingEvent {
     TBooking Booking;
     bool Success;
@@ -35,59 +31,6 @@ struct TCheckoutEvent {
     TCost Cost;
 };
 
-class THotelStats {
-public:
-    THotelStats(const TRoomCounts& roomCounts)
-        : RoomCounts(roomCounts)
-    {
-    }
-
-    void AddAcceptedBooking() {
-        ++AcceptedBookings;
-    }
-
-    void AddRejectedBooking() {
-        ++RejectedBookings;
-    }
-
-    unsigned GetAcceptedBookings() const {
-        return AcceptedBookings;
-    }
-
-    unsigned GetTotalBookings() const {
-        return AcceptedBookings + RejectedBookings;
-    }
-
-    void AddRoomsOccupanccy(ERoomType roomType, unsigned day, double occupancy) {
-        if (RoomsOccupancy[roomType].size() <= day) {
-            RoomsOccupancy[roomType].resize(day + 1);
-        }
-        RoomsOccupancy[roomType][day] = occupancy;
-    }
-
-    double GetRoomOccupancy(ERoomType roomType) const {
-        const auto& occupancy = RoomsOccupancy.at(roomType);
-        return std::reduce(occupancy.begin(), occupancy.end()) / occupancy.size();
-    }
-
-    double GetRoomOccupancy() const {
-        double occupancy = 0;
-        unsigned totalRoomCounts = 0;
-        for (const auto roomType : ROOM_TYPES) {
-            occupancy += RoomCounts.at(roomType) * GetRoomOccupancy(roomType);
-            totalRoomCounts += RoomCounts.at(roomType);
-        }
-        return occupancy / totalRoomCounts;
-    }
-
-private:
-    const TRoomCounts& RoomCounts;
-
-    unsigned AcceptedBookings = 0;
-    unsigned RejectedBookings = 0;
-    std::unordered_map<ERoomType, std::vector<double>> RoomsOccupancy;
-};
-
 class TStartWindow : public QMainWindow, public IEmulatorObserver {
     Q_OBJECT
 
@@ -113,6 +56,7 @@ private:
     void OnBook(const TBooking& booking, bool success) override;
     void OnCheckin(const TBooking& booking, bool success) override;
     void OnCheckout(const TBooking& booking, TCost cost) override;
+    void OnDayEnd(unsigned day) override;
 
     void DisplayRoomCounts();
     void DisplayTime();
@@ -126,26 +70,27 @@ private:
 private:
     Ui::TStartWindow* ui;
 
-    std::unordered_map<ERoomType, const QLineEdit*> RoomCountInputs;
-    std::unordered_map<ERoomType, const QLineEdit*> RoomCostInputs;
+    TRoomTypeMap<const QLineEdit*> RoomCountInputs;
+    TRoomTypeMap<const QLineEdit*> RoomCostInputs;
 
-    std::unordered_map<ERoomType, QLineEdit*> OutputsOfBusyRooms;
-    std::unordered_map<ERoomType, QLineEdit*> OutputsOfFreeRooms;
+    TRoomTypeMap<QLineEdit*> OutputsOfBusyRooms;
+    TRoomTypeMap<QLineEdit*> OutputsOfFreeRooms;
 
     TRoomCosts RoomCosts;
     TRoomCounts RoomCounts;
-    TRoomCounts BusyRooms;
-
-    TCost TotalProfit = 0;
 
     std::vector<TBookingEvent> Bookings;
     std::vector<TCheckinEvent> Checkins;
     std::vector<TCheckoutEvent> Checkouts;
 
     std::unique_ptr<THotelStats> HotelStats;
+    std::unique_ptr<TMemoryReporter> MemoryReporter;
+    // Куда сохранить отчет о памяти по дням; пусто - не сохранять
+    std::string MemoryReportPath;
 
     std::unique_ptr<TClock> Clock;
     std::unique_ptr<IBookingSystem> BookingSystem;
+    std::unique_ptr<TResultExporter> ResultExporter;
     std::unique_ptr<IEmulator> Emulator;
     QTimer EmulationTimer;
 };
@@ -0,0 +1,35 @@
+#include "unit_test.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+std::vector<TTestCase>& GetTestCases() {
+    static std::vector<TTestCase> testCases;
+    return testCases;
+}
+
+// Без аргументов запускает все проверки, иначе только перечисленные по имени
+int main(int argc, char* argv[]) {
+    size_t failed = 0;
+    size_t run = 0;
+    for (const auto& testCase : GetTestCases()) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || !std::strcmp(argv[i], testCase.Name);
+        }
+        if (!selected) {
+            continue;
+        }
+        ++run;
+        try {
+            testCase.Function();
+            std::cout << "OK    " << testCase.Name << std::endl;
+        } catch (const std::exception& e) {
+            ++failed;
+            std::cout << "FAIL  " << testCase.Name << ": " << e.what() << std::endl;
+        }
+    }
+    std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+    return failed == 0 && run > 0 ? 0 : 1;
+}
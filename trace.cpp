@@ -0,0 +1,308 @@
+#include "trace.h"
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::atomic_bool TTracer::Enabled{false};
+
+namespace {
+    struct TSpan {
+        const char* Name;
+        uint64_t StartNs;
+        uint64_t EndNs;
+    };
+
+    // Кольцо с одним писателем (своим потоком) и одним читателем (выгрузкой)
+    class TThreadBuffer {
+    public:
+        static constexpr size_t CAPACITY = 1 << 16;
+
+    public:
+        explicit TThreadBuffer(uint32_t threadId)
+            : ThreadId(threadId)
+            , Spans(new TSpan[CAPACITY])
+        {
+        }
+
+        // Возвращает true, когда буфер только что заполнился наполовину
+        bool Push(const TSpan& span) {
+            const auto written = Written.load(std::memory_order_relaxed);
+            const auto used = written - Read.load(std::memory_order_acquire);
+            if (used == CAPACITY) {
+                Dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            Spans[written % CAPACITY] = span;
+            Written.store(written + 1, std::memory_order_release);
+            return used + 1 == CAPACITY / 2;
+        }
+
+        template <typename TFunc>
+        void Drain(TFunc&& func) {
+            const auto written = Written.load(std::memory_order_acquire);
+            auto read = Read.load(std::memory_order_relaxed);
+            for (; read != written; ++read) {
+                func(Spans[read % CAPACITY]);
+            }
+            Read.store(read, std::memory_order_release);
+        }
+
+        uint32_t GetThreadId() const {
+            return ThreadId;
+        }
+
+        uint64_t GetDropped() const {
+            return Dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        const uint32_t ThreadId;
+        std::unique_ptr<TSpan[]> Spans;
+        std::atomic<uint64_t> Written{0};
+        std::atomic<uint64_t> Read{0};
+        std::atomic<uint64_t> Dropped{0};
+    };
+
+    struct TThreadSpan {
+        uint32_t ThreadId;
+        TSpan Span;
+    };
+
+    // Фоновая выгрузка буферов в поток, см. TTracer::StartStreaming
+    struct TStream {
+        std::ostream& Out;
+        const std::chrono::milliseconds FlushPeriod;
+        bool First = true;
+        // Отрезки, забранные из буферов; форматируются уже без блокировки реестра
+        std::vector<TThreadSpan> Collected;
+        // под TRegistry::FlushMutex
+        bool Stopping = false;
+        std::thread Flusher;
+
+        TStream(std::ostream& out, std::chrono::milliseconds flushPeriod)
+            : Out(out)
+            , FlushPeriod(flushPeriod)
+        {
+        }
+    };
+
+    // Буферы переживают свои потоки, чтобы отрезки завершившихся потоков тоже попали в трассу
+    struct TRegistry {
+        std::mutex Mutex;
+        std::vector<std::shared_ptr<TThreadBuffer>> Buffers;
+        std::unique_ptr<TStream> Stream;
+        // Будят выгрузку раньше срока, когда буфер потока заполнен наполовину.
+        // Живут вместе с реестром, поэтому потоки могут будить и после StopStreaming.
+        std::mutex FlushMutex;
+        std::condition_variable FlushCondition;
+        bool FlushRequested = false;
+    };
+
+    TRegistry& GetRegistry() {
+        static TRegistry registry;
+        return registry;
+    }
+
+    TThreadBuffer& GetThreadBuffer() {
+        thread_local std::shared_ptr<TThreadBuffer> buffer = [] {
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> guard(registry.Mutex);
+            auto result = std::make_shared<TThreadBuffer>(registry.Buffers.size() + 1);
+            registry.Buffers.push_back(result);
+            return result;
+        }();
+        return *buffer;
+    }
+
+    // Вызывается под registry.Mutex
+    uint64_t CountDropped(const TRegistry& registry) {
+        uint64_t result = 0;
+        for (const auto& buffer : registry.Buffers) {
+            result += buffer->GetDropped();
+        }
+        return result;
+    }
+
+    // Вызывается под registry.Mutex; только копирование, чтобы буферы освобождались быстро
+    void CollectSpans(const TRegistry& registry, std::vector<TThreadSpan>& spans) {
+        for (const auto& buffer : registry.Buffers) {
+            const auto threadId = buffer->GetThreadId();
+            buffer->Drain([&](const TSpan& span) {
+                spans.push_back({threadId, span});
+            });
+        }
+    }
+
+    void AppendEscaped(std::string& line, const char* text) {
+        for (; *text; ++text) {
+            if (*text == '"' || *text == '\\') {
+                line += '\\';
+            }
+            line += *text;
+        }
+    }
+
+    void AppendNumber(std::string& line, uint64_t value) {
+        char buffer[24];
+        const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+        line.append(buffer, end);
+    }
+
+    // Наносекунды как микросекунды с тремя знаками после точки
+    void AppendMicroseconds(std::string& line, uint64_t ns) {
+        AppendNumber(line, ns / 1000);
+        const auto fraction = ns % 1000;
+        line += '.';
+        line += static_cast<char>('0' + fraction / 100);
+        line += static_cast<char>('0' + fraction / 10 % 10);
+        line += static_cast<char>('0' + fraction % 10);
+    }
+
+    // Форматирование через std::ostream с плавающей точкой не успевает за потоками,
+    // поэтому событие собирается в строку вручную
+    void WriteSpans(std::ostream& out, const std::vector<TThreadSpan>& spans, bool& first) {
+        std::string line;
+        for (const auto& [threadId, span] : spans) {
+            line.clear();
+            line += first ? "\n" : ",\n";
+            line += "{\"name\":\"";
+            AppendEscaped(line, span.Name);
+            line += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            AppendNumber(line, threadId);
+            line += ",\"ts\":";
+            AppendMicroseconds(line, span.StartNs);
+            line += ",\"dur\":";
+            AppendMicroseconds(line, span.EndNs - span.StartNs);
+            line += '}';
+            out.write(line.data(), line.size());
+            first = false;
+        }
+    }
+
+    // Потери не должны пройти незамеченными: трасса без части отрезков выглядит правдоподобно,
+    // поэтому их число пишется и в саму трассу, и в stderr
+    void WriteFooter(std::ostream& out, uint64_t dropped) {
+        out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":" << dropped << "}}\n";
+        if (dropped != 0) {
+            std::cerr << "Trace: " << dropped << " spans dropped because per-thread buffers overflowed" << std::endl;
+        }
+    }
+
+    void RequestFlush(TRegistry& registry) {
+        {
+            std::lock_guard<std::mutex> guard(registry.FlushMutex);
+            registry.FlushRequested = true;
+        }
+        registry.FlushCondition.notify_one();
+    }
+
+    void RunFlusher(TRegistry& registry, TStream& stream) {
+        std::unique_lock<std::mutex> lock(registry.FlushMutex);
+        while (true) {
+            registry.FlushCondition.wait_for(lock, stream.FlushPeriod, [&] {
+                return stream.Stopping || registry.FlushRequested;
+            });
+            if (stream.Stopping) {
+                return;
+            }
+            registry.FlushRequested = false;
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> guard(registry.Mutex);
+                CollectSpans(registry, stream.Collected);
+            }
+            WriteSpans(stream.Out, stream.Collected, stream.First);
+            stream.Collected.clear();
+            stream.Out.flush();
+            lock.lock();
+        }
+    }
+}
+
+void TTracer::Record(const char* name, uint64_t startNs, uint64_t endNs) {
+    if (GetThreadBuffer().Push({name, startNs, endNs})) {
+        RequestFlush(GetRegistry());
+    }
+}
+
+void TTracer::WriteChromeTrace(std::ostream& out) {
+    auto& registry = GetRegistry();
+    std::vector<TThreadSpan> spans;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> guard(registry.Mutex);
+        CollectSpans(registry, spans);
+        dropped = CountDropped(registry);
+    }
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    WriteSpans(out, spans, first);
+    WriteFooter(out, dropped);
+}
+
+void TTracer::StartStreaming(std::ostream& out, std::chrono::milliseconds flushPeriod) {
+    auto& registry = GetRegistry();
+    if (registry.Stream) {
+        throw std::runtime_error("Trace streaming is already started");
+    }
+    registry.Stream = std::make_unique<TStream>(out, flushPeriod);
+    out << "{\"traceEvents\":[";
+    registry.Stream->Flusher = std::thread(RunFlusher, std::ref(registry), std::ref(*registry.Stream));
+    Enable();
+}
+
+void TTracer::StopStreaming() {
+    auto& registry = GetRegistry();
+    if (!registry.Stream) {
+        return;
+    }
+    Enable(false);
+    auto& stream = *registry.Stream;
+    {
+        std::lock_guard<std::mutex> guard(registry.FlushMutex);
+        stream.Stopping = true;
+    }
+    registry.FlushCondition.notify_one();
+    stream.Flusher.join();
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> guard(registry.Mutex);
+        CollectSpans(registry, stream.Collected);
+        dropped = CountDropped(registry);
+    }
+    WriteSpans(stream.Out, stream.Collected, stream.First);
+    WriteFooter(stream.Out, dropped);
+    stream.Out.flush();
+    registry.Stream.reset();
+}
+
+uint64_t TTracer::GetDroppedSpans() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.Mutex);
+    return CountDropped(registry);
+}
+
+TTraceFile::TTraceFile(const std::string& path)
+    : Out(path)
+{
+    if (!Out) {
+        throw std::runtime_error("Can't open trace file " + path);
+    }
+    TTracer::StartStreaming(Out);
+}
+
+TTraceFile::~TTraceFile() {
+    TTracer::StopStreaming();
+}
+
+uint64_t TTracer::Now() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
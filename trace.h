@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+// Трассировка участков кода для просмотра в chrome://tracing или ui.perfetto.dev.
+// Каждый поток пишет отрезки в свой кольцевой буфер без блокировок, WriteChromeTrace
+// забирает накопленное из всех буферов. Буфер вмещает 65536 отрезков, поэтому для долгих
+// запусков есть StartStreaming: фоновый поток выгружает буферы в файл по ходу работы.
+// Пока трассировка выключена, отрезок стоит одну атомарную загрузку.
+class TTracer {
+public:
+    static void Enable(bool enabled = true) {
+        Enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() {
+        return Enabled.load(std::memory_order_relaxed);
+    }
+
+    // name должен жить до выгрузки трассы, обычно это строковый литерал
+    static void Record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Выгружает в out накопленные с прошлой выгрузки отрезки в формате Chrome trace JSON.
+    // Число потерянных отрезков пишется в otherData.droppedSpans и, если оно не ноль, в stderr.
+    static void WriteChromeTrace(std::ostream& out);
+
+    // Включает трассировку и раз в flushPeriod (или раньше, если буфер потока заполнен
+    // наполовину) переносит отрезки из буферов в out.
+    // out должен жить до StopStreaming; Start и Stop вызываются из одного потока.
+    static void StartStreaming(std::ostream& out, std::chrono::milliseconds flushPeriod = std::chrono::milliseconds(10));
+    // Выключает трассировку, дописывает оставшиеся отрезки и закрывает JSON
+    static void StopStreaming();
+
+    // Сколько отрезков потеряно из-за переполнения буферов с начала работы
+    static uint64_t GetDroppedSpans();
+
+    static uint64_t Now();
+
+private:
+    static std::atomic_bool Enabled;
+};
+
+// Пишет трассу в файл по ходу работы: StartStreaming в конструкторе, StopStreaming в деструкторе,
+// так что трасса закрывается и при выходе по исключению
+class TTraceFile {
+public:
+    explicit TTraceFile(const std::string& path);
+    ~TTraceFile();
+
+    TTraceFile(const TTraceFile&) = delete;
+    TTraceFile& operator=(const TTraceFile&) = delete;
+
+private:
+    std::ofstream Out;
+};
+
+class TTraceSpan {
+public:
+    explicit TTraceSpan(const char* name)
+        : Name(name)
+        , StartNs(TTracer::IsEnabled() ? TTracer::Now() : 0)
+    {
+    }
+
+    ~TTraceSpan() {
+        if (StartNs) {
+            TTracer::Record(Name, StartNs, TTracer::Now());
+        }
+    }
+
+    TTraceSpan(const TTraceSpan&) = delete;
+    TTraceSpan& operator=(const TTraceSpan&) = delete;
+
+private:
+    const char* const Name;
+    const uint64_t StartNs;
+};
+
+#define TRACE_SPAN_CONCAT_IMPL(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_IMPL(a, b)
+#define TRACE_SPAN(name) TTraceSpan TRACE_SPAN_CONCAT(traceSpan, __LINE__)(name)
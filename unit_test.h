@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Минимальные самопроверки без внешних библиотек.
+// TEST регистрирует проверку, CHECK бросает исключение с местом и текстом условия;
+// все проверки запускает booking_tests
+struct TTestCase {
+    const char* Name;
+    void (*Function)();
+};
+
+std::vector<TTestCase>& GetTestCases();
+
+struct TTestRegistration {
+    TTestRegistration(const char* name, void (*function)()) {
+        GetTestCases().push_back({name, function});
+    }
+};
+
+#define TEST(Name) \
+    static void Name(); \
+    static const TTestRegistration Name##Registration(#Name, Name); \
+    static void Name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            throw std::runtime_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": CHECK(" #condition ") failed"); \
+        } \
+    } while (false)